@@ -12,15 +12,25 @@
 // CONFIGURATION & SETTINGS
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////|
 #define KB_COOLDOWN 50                          // Keypress cooldown
-#define FULL_REFRESH_AFTER 5                    // Full refresh after N partial refreshes (CHANGE WITH CAUTION)
+#define GHOSTING_DEBT_BUDGET 200                // Slow full refresh once any screen region has flipped this % of its pixels (CHANGE WITH CAUTION)
+#define PARTIAL_DIFF_MAX_PERCENT 50             // Changed area (% of screen) above which refresh() redraws the full screen
+#define FONT_CACHE_SIZE 48                      // Fonts EINK().fontMetrics() can hold, at least every font the library ships plus the built-in one
 #define MAX_FILES 10                            // Number of files to store
+#define DIR_CACHE_SIZE 8                        // Number of directory listings kept in RAM
 #define FORMAT_SPIFFS_IF_FAILED true            // Format the SPIFFS filesystem if mount fails
 #define SLEEPMODE "TEXT"                        // TEXT, SPLASH, CLOCK
 #define TXT_APP_STYLE 1                         // 0: Old Style (NOT SUPPORTED), 1: New Style
 #define SET_CLOCK_ON_UPLOAD false               // Should system clock be set automatically on code upload?
 #define TOUCH_TIMEOUT_MS 1200                   // Delay after scrolling to return to typing mode (ms)
-#define SYS_METADATA_FILE "/sys/SDMMC_META.txt" // File path to the file system metadata file
+#define SYS_METADATA_FILE "/sys/SDMMC_META.txt" // Old text metadata file, migrated into SYS_METADATA_STORE
+#define SYS_METADATA_STORE "/sys/SDMMC_META.bin" // File path to the file system metadata store
+#define SYS_LAYOUT_MARKER "/sys/.layout"        // Written once setupSD() has created the directories and guides
+#define SD_LAYOUT_VERSION 2                     // Bump when that scaffolding changes, the next boot redoes it
 #define POWER_SAVE_FREQ 40                      // CPU freq for power save mode
+#define SD_SESSION_GRACE_MS 500                 // Time after the last SD operation before the CPU drops to POWER_SAVE_FREQ (ms)
+#define SD_BUFFER_BYTES 4096                    // Read-ahead / write-behind buffer of a PocketmageFile (multiple of 512)
+#define SD_IO_PREFETCH_DEPTH 4                  // Queued prefetch requests kept before the oldest is dropped
+#define SD_COPY_BUFFER_BYTES 32768              // Copy engine buffer in DMA-capable RAM, halved down to 4 KB if the heap is short
 #define IDLE_TIME 20000                         // time to wait for mage idle (ms)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////|
 
@@ -3,54 +3,13 @@
 #include <Adafruit_GFX.h>
 #include <vector>
 #include <GxEPD2_BW.h>
+#include <FS.h>
+#include <pocketmage_textsource.h>
 
 // ===================== FRAME CLASS =====================
 # define MAX_FRAMES 100
 # define X_OFFSET 4
 #pragma region textSource
-// bit flags for alignment or future options
-enum LineFlags : uint8_t { LF_NONE=0, LF_RIGHT= 1<<0, LF_CENTER= 1<<1 };
-struct LineView {
-  const char* ptr;   // points to NUL-terminated string in RAM or PROGMEM
-  uint16_t    len;   // byte length (no need to include '\0')
-  uint8_t     flags; // LineFlags
-};
-// read-only interface for any line list (PROGMEM table, arena, etc.)
-struct TextSource {
-  virtual ~TextSource() {}
-  virtual size_t   size() const = 0;
-  virtual LineView line(size_t i) const = 0; 
-};
-template<size_t MAX_LINES, size_t BUF_BYTES>
-struct FixedArenaSource : TextSource {
-  char     buf[BUF_BYTES];
-  uint16_t off[MAX_LINES];
-  uint16_t len_[MAX_LINES];
-  uint8_t  flags_[MAX_LINES];
-  size_t   nLines = 0;
-  size_t   used   = 0;
-
-  size_t size() const override { return nLines; }
-
-  LineView line(size_t i) const override {
-    return { buf + off[i], len_[i], flags_[i] };
-  }
-
-  void clear() { nLines = 0; used = 0; }
-
-  // Returns false if out of capacity; caller can choose to drop the oldest, etc.
-  bool pushLine(const char* s, uint16_t L, uint8_t flags = LF_NONE) {
-    if (nLines >= MAX_LINES || used + L + 1 > BUF_BYTES) return false;
-    memcpy(buf + used, s, L);
-    buf[used + L] = '\0';
-    off[nLines]   = (uint16_t)used;
-    len_[nLines]  = L;
-    flags_[nLines]= flags;
-    used         += L + 1;
-    nLines++;
-    return true;
-  }
-};
 struct ProgmemTableSource : TextSource {
   // table is a PROGMEM array of PROGMEM pointers to '\0'-terminated strings
   const char* const* table; // PROGMEM
@@ -68,6 +27,51 @@ struct ProgmemTableSource : TextSource {
   }
 };
 
+// Lines of a text file on SD, for frames larger than RAM. open() makes one buffered pass to
+// build a sparse index (first line + byte offset of every page of whole lines), then line(i)
+// decodes pages on demand into a small LRU so scrolling only touches the card on a miss.
+// A LineView stays valid until the next line() call. Lines longer than a page are truncated.
+#define FILE_SOURCE_PAGE_BYTES 4096
+#define FILE_SOURCE_PAGES      4
+class FileTextSource : public TextSource {
+public:
+  FileTextSource() {}
+  ~FileTextSource() { close(); }
+
+  bool open(fs::FS& fs, const char* path);
+  void close();
+  bool isOpen() const { return (bool)file_; }
+
+  size_t   size() const override { return nLines_; }
+  LineView line(size_t i) const override;
+  uint32_t version() const override { return version_; }
+
+  uint32_t cacheHits()   const { return hits_; }
+  uint32_t cacheMisses() const { return misses_; }
+
+private:
+  struct Anchor { uint32_t line; uint32_t offset; };
+  struct Page {
+    int32_t               id      = -1;
+    uint32_t              lastUse = 0;
+    std::vector<char>     data;
+    std::vector<uint16_t> starts;
+    std::vector<uint16_t> lens;
+  };
+  const Page& page(size_t id) const;
+
+  mutable fs::File    file_;
+  uint32_t            fileSize_ = 0;
+  size_t              nLines_   = 0;
+  std::vector<Anchor> anchors_;
+  uint32_t            version_  = 0;
+
+  mutable Page        pages_[FILE_SOURCE_PAGES];
+  mutable uint32_t    useClock_ = 0;
+  mutable uint32_t    hits_     = 0;
+  mutable uint32_t    misses_   = 0;
+};
+
 extern const char* const HELP_LINES[] PROGMEM;
 extern const size_t HELP_COUNT;
 extern const char* const UNIT_TYPES_LINES[] PROGMEM;
@@ -140,6 +144,23 @@ public:
   const uint8_t* bitmap    = nullptr;  // for bitmap frames
   const GFXfont *font = (GFXfont *)&FreeSerif9pt7b;
 
+  // wrap cache: visual rows of the visible source lines, filled lazily as they are drawn
+  struct WrapSlice { uint32_t line; uint16_t off; uint16_t len; };
+  std::vector<WrapSlice> wrapSlices;        // rows of each wrapped line are contiguous
+  std::vector<int32_t>   wrapFirst;         // per visible line from wrapBase: first row in wrapSlices, -1 = not wrapped yet
+  uint32_t               wrapBase    = 0;   // source line of wrapFirst[0]
+  const TextSource*      wrapSource  = nullptr;
+  uint32_t               wrapVersion = 0;
+  const GFXfont*         wrapFont    = nullptr;
+  int                    wrapWidth   = -1;
+
+  // dirty tracking: state last sent to the panel, see frameIsDirty()
+  bool              dirty        = true;     // set for changes the frame can't see (moved, restyled)
+  long              drawnScroll  = -1;
+  int               drawnChoice  = -1;
+  const TextSource* drawnSource  = nullptr;
+  uint32_t          drawnVersion = 0;
+
   
   // base constructor for common fields
   Frame(int left, int right, int top, int bottom, 
@@ -184,9 +205,10 @@ extern std::vector<Frame*> frames;
 // <FRAMES.cpp>
   // main functions
 void einkFramesDynamic(std::vector<Frame*> &frames, bool doFull_);
+bool frameIsDirty(const Frame& frame);
   // text boxes
 std::vector<String> formatText(Frame &frame,int maxTextWidth);
-void drawLineInFrame(String &srcLine, int lineIndex, Frame &frame, int usableY, bool clearLine, bool isPartial);
+void drawLineInFrame(const char* text, size_t len, uint8_t flags, bool choiceMarker, int lineIndex, Frame &frame, int usableY, bool clearLine, bool isPartial);
 void drawFrameBox(int usableX, int usableY, int usableWidth, int usableHeight,bool invert);
 int computeCursorX(Frame &frame, bool rightAlign, bool centerAlign, int16_t x1, uint16_t lineWidth);
   // String formatting
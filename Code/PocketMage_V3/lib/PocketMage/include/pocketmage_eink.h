@@ -10,7 +10,10 @@
 #include <Arduino.h>
 #include <GxEPD2_BW.h>
 #include <vector>
-#include <config.h> // for FULL_REFRESH_AFTER
+#include <array>
+#include <atomic>
+#include <config.h> // for GHOSTING_DEBT_BUDGET, FONT_CACHE_SIZE
+#include <pocketmage_text.h>
 #pragma region fonts
 // FONTS
 // Small
@@ -32,13 +35,57 @@
 
 // Type alias for readability
 using PanelT   = GxEPD2_310_GDEQ031T10;
-using DisplayT = GxEPD2_BW<PanelT, PanelT::HEIGHT>;
+
+// GxEPD2 display that also mirrors every pixel into a full-screen back buffer in panel
+// layout. refresh() snapshots that buffer for the flush task, so apps can start drawing
+// the next frame while the panel is still updating.
+class PipelinedDisplay : public GxEPD2_BW<PanelT, PanelT::HEIGHT> {
+public:
+  using Base = GxEPD2_BW<PanelT, PanelT::HEIGHT>;
+  using Base::Base;
+  static constexpr size_t BUFFER_BYTES = (PanelT::WIDTH / 8) * PanelT::HEIGHT;
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+  void setFullWindow();
+  void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+  const uint8_t* backBuffer() const { return backBuffer_; }
+  const GFXfont* getFont() const { return gfxFont; }
+  void getWindow(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h) const { x = pwX_; y = pwY_; w = pwW_; h = pwH_; }
+
+private:
+  uint8_t  backBuffer_[BUFFER_BYTES];
+  // current window in panel coordinates, same rounding as GxEPD2
+  uint16_t pwX_ = 0, pwY_ = 0, pwW_ = PanelT::WIDTH, pwH_ = PanelT::HEIGHT;
+};
+using DisplayT = PipelinedDisplay;
 
 // E-ink display
 extern DisplayT display;
 
 extern void einkHandler(void *parameter);
 
+// ===================== FONT METRICS =====================
+// Ink bounds of a string in a given font, see pocketmage_text.h
+using InkBounds = InkBoundsT<GFXfont>;
+
+// Per-font numbers, computed once per GFXfont by EINK().fontMetrics()
+struct FontMetrics {
+  const GFXfont* font         = nullptr;              // nullptr: built-in 6x8 font
+  uint8_t        lineHeight   = 8;                    // yAdvance
+  uint8_t        ascent       = 7;                    // tallest glyph above the baseline
+  uint8_t        capHeight    = 7;                    // ink height of "H"
+  uint8_t        spaceWidth   = 6;                    // advance of ' '
+  uint16_t       avgCharWidth = 6;                    // ink width of a-z / 26
+  uint8_t        advance[95]  = {};                   // advance of ' '..'~'
+
+  uint16_t textWidth(const char* s) const           { return textWidth(s, strlen(s)); }
+  uint16_t textWidth(const char* s, size_t n) const { InkBounds b(font); b.add(s, n); return b.width(); }
+  uint16_t textHeight(const char* s) const          { InkBounds b(font); b.add(s, strlen(s)); return b.height(); }
+  uint16_t advanceWidth(const char* s, size_t n) const;  // how far the cursor moves
+};
+
 // ===================== EINK CLASS =====================
 class PocketmageEink {
 public:
@@ -46,14 +93,34 @@ public:
 
   // Wire up external buffers/state used to read from globals
   void setLineSpacing(uint8_t lineSpacing)                      { lineSpacing_ = lineSpacing; };               // reference to lineSpacing (default 6)
-  void setFullRefreshAfter(uint8_t fullRefreshAfter)  { fullRefreshAfter_ = fullRefreshAfter; };               // reference to FULL_REFRESH_AFTER (default 5)
   void setCurrentFont(const GFXfont* font){
   if (currentFont_ == font) return; 
     currentFont_ = font;
   };                       // reference to currentFont
   
+  // Refresh pipeline stats, see refresh()
+  struct RefreshStats {
+    uint32_t submitted    = 0;  // frames handed to refresh()
+    uint32_t flushed      = 0;  // frames pushed to the panel
+    uint32_t dropped      = 0;  // frames replaced by a newer one before they were pushed
+    uint32_t partial      = 0;  // frames sent as a partial window around the changed pixels
+    uint32_t unchanged    = 0;  // frames identical to what the panel shows, not sent
+    uint32_t fastFull     = 0;  // fast full refreshes
+    uint32_t slowFull     = 0;  // slow full refreshes, clear the ghosting debt
+    uint32_t lastPushMs   = 0;  // ms the panel took for the last frame
+    uint32_t lastLatency  = 0;  // ms from refresh() to panel done, last frame
+    uint32_t maxLatency   = 0;  // ms, worst seen
+  };
+
   // Main display functions
   void refresh();
+  void waitForFlush();
+  void lockPanel();
+  void unlockPanel();
+  RefreshStats getRefreshStats() const { return stats_; }
+  void startFlushTask();
+  void flushTask();                                             // body of the flush task
+  void windowShown();                                           // current window was sent to the panel, panel must be locked
   void multiPassRefresh(int passes);
   void setFastFullRefresh(bool setting);
   void statusBar(const String& input, bool fullWindow=false);
@@ -64,6 +131,7 @@ public:
   void resetDisplay(bool clearScreen=true,uint16_t color = GxEPD_WHITE);
   int  countLines(const String& input, size_t maxLineLength = 29);
   uint16_t getEinkTextWidth(const String& s);
+  const FontMetrics& fontMetrics(const GFXfont* font);
 
   // getters To Do: migrate definitions here from pocketmage_eink.cpp
   uint8_t maxCharsPerLine() const;
@@ -77,11 +145,37 @@ public:
 private:
   DisplayT&             display_; // class reference to hardware display object
   bool                  forceSlowFullUpdate_  = false;
-  uint8_t               partialCounter_       = 0;
   const GFXfont*        currentFont_          = nullptr;
-  uint8_t               fullRefreshAfter_     = FULL_REFRESH_AFTER;
+
+  // ghosting debt: pixels flipped per screen region since the last slow full refresh
+  static constexpr int  GHOST_REGION_BYTES    = 6;          // 48 px wide
+  static constexpr int  GHOST_REGION_ROWS     = 64;
+  static constexpr int  GHOST_COLS            = (PanelT::WIDTH / 8) / GHOST_REGION_BYTES;
+  static constexpr int  GHOST_ROWS            = PanelT::HEIGHT / GHOST_REGION_ROWS;
+  void     addGhostDebt_(const uint8_t* buffer, int b0, int y0, int b1, int y1);
+  uint32_t ghostDebtPercent_() const;
+  uint32_t              ghostDebt_[GHOST_ROWS * GHOST_COLS] = {};
+
+  // refresh pipeline: refresh() fills pending_, the flush task swaps it with inflight_
+  void pushToPanel_(const uint8_t* buffer, bool slowFull);
+  TaskHandle_t          flushTaskHandle_      = NULL;
+  SemaphoreHandle_t     frameMutex_           = NULL;       // guards pending_ and its flags
+  SemaphoreHandle_t     panelMutex_           = NULL;       // one user of the panel bus at a time
+  uint8_t*              pending_              = nullptr;
+  uint8_t*              inflight_             = nullptr;
+  volatile bool         pendingReady_         = false;
+  volatile bool         flushing_             = false;
+  bool                  pendingSlow_          = false;
+  ulong                 pendingSince_         = 0;
+  bool                  shownValid_           = false;      // shadow of the panel content is usable for diffing
+  RefreshStats          stats_;
 
   // font metrics
+  // Entries never move once published, so the references fontMetrics() hands out stay valid
+  std::array<FontMetrics, FONT_CACHE_SIZE> fontCache_;       // one entry per font seen, never evicted
+  std::atomic<size_t>   fontCount_{0};                      // entries below this are complete
+  std::atomic<size_t>   lastFont_{0};                       // index of the last hit
+  SemaphoreHandle_t     fontMutex_            = NULL;       // one task adding an entry at a time
   uint8_t               lineSpacing_          = 6;
   uint8_t               maxCharsPerLine_      = 0;
   uint8_t               maxLines_             = 0;
@@ -9,6 +9,13 @@
 #pragma once
 #include <Arduino.h>
 #include <FS.h>
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <pocketmage_store.h>
 
 // forward-declaration to avoid including U8g2lib.h, GxEPD2_BW.h, pocketmage_oled.h, and pocketmage_eink.h
 class PocketmageOled;
@@ -19,68 +26,112 @@ static String editingFile = "";
 static String workingFile = "";
 static String filesList[10];
 
-// ===================== SD CLASS =====================
-class PocketmageSDAUTO {
+// ===================== STORAGE LOCK =====================
+// One task at a time on global_fs. Recursive, so nested holders on the same task are fine.
+// Cheap to take, it doesn't touch the clock, SDSession holds one for its whole lifetime.
+class SDLock {
 public:
-  explicit PocketmageSDAUTO() {}
-
-  void saveFile();
-  void writeMetadata(const String& path);
-  void loadFile(bool showOLED = true);
-  void delFile(String fileName);
-  void deleteMetadata(String path);
-  void renFile(String oldFile, String newFile);
-  void renMetadata(String oldPath, String newPath);
-  void copyFile(String oldFile, String newFile);
-  void appendToFile(String path, String inText);
+  SDLock();
+  ~SDLock();
+  SDLock(const SDLock&) = delete;
+  SDLock& operator=(const SDLock&) = delete;
 
-  // Getters / Setters
-  bool getNoSD()  {return noSD;}
-  void setNoSD(bool in) {noSD = in;}
+  static bool heldByMe();   // the calling task holds the lock
+};
 
-  String getWorkingFile()  {return workingFile;}
-  void setWorkingFile(String in) {workingFile = in;}
+// ===================== STORAGE SESSION =====================
+// Hold one of these for the duration of any SD work. The first live session raises the CPU to
+// 240 MHz and sets SDActive, nested and back-to-back sessions reuse the raised clock, and it only
+// drops back to POWER_SAVE_FREQ once no session has been open for SD_SESSION_GRACE_MS.
+// A session also holds SDLock, so sessions on other tasks wait until it closes.
+class SDSession {
+public:
+  struct Stats {
+    uint32_t sessions  = 0;   // sessions opened, nested ones included
+    uint32_t rampUps   = 0;   // times the clock actually had to be raised
+    uint32_t rampDowns = 0;   // times the grace period ran out
+    uint32_t activeMs  = 0;   // total time with at least one session open
+    uint32_t longestMs = 0;   // longest stretch with a session open
+  };
 
-  String getEditingFile()  {return editingFile;}
-  void setEditingFile(String in) {editingFile = in;}
+  SDSession();
+  ~SDSession();
+  SDSession(const SDSession&) = delete;
+  SDSession& operator=(const SDSession&) = delete;
 
-  String getFilesListIndex(int index) {return filesList[index];}
-  void setFilesListIndex(int index, String content) {filesList[index] = content;}
-
-  // low level methods  To Do: remove arguments for fs::FS &fs and reference internal fs::FS* instead
-  void listDir(fs::FS &fs, const char *dirname);
-  void readFile(fs::FS &fs, const char *path);
-  String readFileToString(fs::FS &fs, const char *path);
-  void writeFile(fs::FS &fs, const char *path, const char *message);
-  void appendFile(fs::FS &fs, const char *path, const char *message);
-  void renameFile(fs::FS &fs, const char *path1, const char *path2);
-  void deleteFile(fs::FS &fs, const char *path);
-  // Read a binary file fully into a buffer
-  bool readBinaryFile(const char* path, uint8_t* buf, size_t len);
-  // Convenience: read file size
-  size_t getFileSize(const char* path);
+  static Stats getStats();
 
 private:
+  SDLock lock_;   // taken before the clock is raised, released after the session is closed
+};
 
-  static constexpr const char*  tag               = "MAGE_SD";
-
-  String editingFile_ = "";
-  String filesList_[MAX_FILES];
-  String workingFile_ = "";
-
-  uint8_t                       fileIndex_        = 0;
-  String                        excludedFiles_[3] = { "/temp.txt", "/settings.txt", "/tasks.txt" };
+// ===================== BUFFERED FILE =====================
+// fs::File with a read-ahead / write-behind buffer, for code that reads or writes a few bytes at
+// a time (read(), readStringUntil(), print()). Refills and flushes land on multiples of the buffer
+// size, so with the default power of two buffer they stay on sector and cluster boundaries.
+// Reads and writes of a buffer or more skip the copy and go straight to the card.
+class PocketmageFile : public Stream {
+public:
+  explicit PocketmageFile(size_t bufferBytes = 0);   // 0: SD_BUFFER_BYTES, rounded up to 512
+  ~PocketmageFile();
+  PocketmageFile(const PocketmageFile&) = delete;
+  PocketmageFile& operator=(const PocketmageFile&) = delete;
+
+  bool open(const char* path, const char* mode = FILE_READ);
+  bool open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+  void close();
+  explicit operator bool() const { return (bool)file_; }
+
+  // Stream
+  int    available() override;
+  int    read() override;
+  int    peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  void   flush() override;
+  using Print::write;
+
+  size_t read(uint8_t* buf, size_t len);
+  bool   seek(uint32_t pos);
+  size_t position() const;
+  size_t size() const;
+  bool   isDirectory() { return file_.isDirectory(); }
 
-  // Flags / counters
-  bool                          noSD_              = false;
+private:
+  enum Mode : uint8_t { IDLE, READING, WRITING };
+
+  bool fill_();
+  bool flushBuffer_();
+  void toWriting_();
+
+  fs::File file_;
+  uint8_t* buf_      = nullptr;
+  size_t   cap_      = 0;
+  uint32_t bufStart_ = 0;   // file offset of buf_[0]
+  size_t   bufLen_   = 0;   // bytes read into buf_, or waiting to be written
+  size_t   bufPos_   = 0;   // read cursor inside buf_
+  Mode     mode_     = IDLE;
 };
 
-class PocketmageSDMMC {
+// ===================== SD CLASS =====================
+// One implementation for SDMMC and SDSPI (compatibility mode). setupSD() mounts the card with
+// the right driver and points global_fs at it, everything here goes through global_fs.
+class PocketmageSD {
 public:
-  explicit PocketmageSDMMC() {}
+  explicit PocketmageSD() {}
+
+  using CopyProgress = std::function<void(size_t done, size_t total)>;   // bytes
+
+  struct MountStats {
+    bool     fastPath      = false;   // mounted on the first try, no settle delays
+    bool     layoutChecked = false;   // the layout marker was missing or old, scaffolding ran
+    uint32_t mountMs       = 0;
+    uint32_t layoutMs      = 0;
+  };
+  static MountStats getMountStats();   // how setupSD() went this boot
 
   void saveFile();
-  void writeMetadata(const String& path);
+  void writeMetadata(const String& path, long charCount = -1);  // -1: read the file to count
   void loadFile(bool showOLED = true);
   void delFile(String fileName);
   void deleteMetadata(String path);
@@ -88,6 +139,11 @@ public:
   void renMetadata(String oldPath, String newPath);
   void copyFile(String oldFile, String newFile);
   void appendToFile(String path, String inText);
+  void writeLines(String path, const std::vector<String>& lines, bool append = false);  // one open, one metadata update
+
+  // Copy engine behind every copy in the OS: a file, or a directory tree into dst
+  bool copyPath(String src, String dst, CopyProgress progress = nullptr);
+  static void oledCopyProgress(size_t done, size_t total);  // CopyProgress showing a percentage
 
   // Getters / Setters
   bool getNoSD()  {return noSD;}
@@ -102,7 +158,7 @@ public:
   String getFilesListIndex(int index) {return filesList[index];}
   void setFilesListIndex(int index, String content) {filesList[index] = content;}
 
-  // low level methods  To Do: remove arguments for fs::FS &fs and reference internal fs::FS* instead
+  // low level methods, all through PM_STORE(). fs is unused, kept so existing callers still build.
   void listDir(fs::FS &fs, const char *dirname);
   void readFile(fs::FS &fs, const char *path);
   String readFileToString(fs::FS &fs, const char *path);
@@ -114,6 +170,8 @@ public:
   bool readBinaryFile(const char* path, uint8_t* buf, size_t len);
   // Convenience: read file size
   size_t getFileSize(const char* path);
+  // Small read/write throughput, plain File vs PocketmageFile
+  std::vector<String> benchmarkBuffered();
 
 private:
 
@@ -130,62 +188,151 @@ private:
   bool                          noSD_              = false;
 };
 
-class PocketmageSDSPI {
+// ===================== METADATA STORE =====================
+// One fixed-size record per file in SYS_METADATA_STORE, found through a RAM index keyed by a
+// hash of the path, so lookups and updates touch a single record instead of the whole file.
+// The old SYS_METADATA_FILE text format is migrated the first time the store is used.
+class PocketmageMetaStore {
 public:
-  explicit PocketmageSDSPI() {}
+  struct Record {
+    char     path[96];          // empty: free slot
+    char     timestamp[16];     // YYYYMMDD-HHMM
+    uint32_t sizeBytes;
+    uint32_t charCount;
+    uint32_t reserved[2];
+  };
+
+  bool   put(const String& path, const char* timestamp, uint32_t sizeBytes, uint32_t charCount);
+  bool   get(const String& path, Record& out);
+  bool   remove(const String& path);
+  bool   rename(const String& oldPath, const String& newPath);
+  size_t count();
 
-  void saveFile();
-  void writeMetadata(const String& path);
-  void loadFile(bool showOLED = true);
-  void delFile(String fileName);
-  void deleteMetadata(String path);
-  void renFile(String oldFile, String newFile);
-  void renMetadata(String oldPath, String newPath);
-  void copyFile(String oldFile, String newFile);
-  void appendToFile(String path, String inText);
+private:
+  static constexpr uint32_t     headerBytes_       = 16;
+
+  bool     load_();
+  void     migrate_();
+  int      find_(File& f, const char* path, uint32_t hash, Record* out);   // slot or -1
+  bool     readSlot_(File& f, uint16_t slot, Record& r);
+  bool     writeSlot_(File& f, uint16_t slot, const Record& r);
+  void     unindex_(uint32_t hash, uint16_t slot);
+  static uint32_t hash_(const char* s);
+
+  bool                                        loaded_    = false;
+  uint16_t                                    slotCount_ = 0;
+  std::unordered_multimap<uint32_t, uint16_t> index_;      // path hash -> slot
+  std::vector<uint16_t>                       freeSlots_;
+};
 
-  // Getters / Setters
-  bool getNoSD()  {return noSD;}
-  void setNoSD(bool in) {noSD = in;}
+// ===================== DIRECTORY CACHE =====================
+// Listings of recently visited directories, the least recently used one is dropped once
+// DIR_CACHE_SIZE are held. PocketmageSD's write, rename and delete calls invalidate what they
+// touch, so listing an unchanged folder again costs no card I/O. Code that changes the card
+// through global_fs directly has to call invalidate() itself.
+class PocketmageDirCache {
+public:
+  struct Entry {
+    String   name;              // base name, no path
+    bool     isDir;
+    uint32_t size;
+    time_t   mtime;
+  };
+  using Listing    = std::vector<Entry>;
+  using ListingPtr = std::shared_ptr<const Listing>;
+
+  // Loaded from the card on a miss. Shared with the cache and never changed, so it stays valid
+  // through later list(), invalidate() and clear() calls and can be walked without SDLock.
+  // Keep the pointer in a variable while iterating, not a temporary in the range-for.
+  ListingPtr list(const String& dir);
+  void     invalidate(const String& path);    // drops path's parent, and path itself if it was a dir
+  void     clear();                           // the card changed behind our back (USB, remount)
+  uint32_t generation() const { return generation_; }   // bumped by every invalidation
 
-  String getWorkingFile()  {return workingFile;}
-  void setWorkingFile(String in) {workingFile = in;}
+private:
+  struct Node {
+    String     dir;
+    ListingPtr entries;
+  };
 
-  String getEditingFile()  {return editingFile;}
-  void setEditingFile(String in) {editingFile = in;}
+  static String normalize_(String path);
 
-  String getFilesListIndex(int index) {return filesList[index];}
-  void setFilesListIndex(int index, String content) {filesList[index] = content;}
+  std::list<Node>                             lru_;        // most recently used first
+  uint32_t                                    generation_ = 0;
+  uint32_t                                    hits_       = 0;
+  uint32_t                                    misses_     = 0;
+};
 
-  // low level methods  To Do: remove arguments for fs::FS &fs and reference internal fs::FS* instead
-  void listDir(fs::FS &fs, const char *dirname);
-  void readFile(fs::FS &fs, const char *path);
-  String readFileToString(fs::FS &fs, const char *path);
-  void writeFile(fs::FS &fs, const char *path, const char *message);
-  void appendFile(fs::FS &fs, const char *path, const char *message);
-  void renameFile(fs::FS &fs, const char *path1, const char *path2);
-  void deleteFile(fs::FS &fs, const char *path);
-  // Read a binary file fully into a buffer
-  bool readBinaryFile(const char* path, uint8_t* buf, size_t len);
-  // Convenience: read file size
-  size_t getFileSize(const char* path);
+// ===================== STORAGE TASK =====================
+// Runs file requests on a background task so a slow card doesn't stall typing (loop) or
+// rendering (einkHandler). Requests run most urgent first, in order within a priority. Each
+// returns a Ticket that UI code can poll with ready(), or block on with wait(). An optional
+// callback runs on the storage task when the request completes, so keep it short and don't draw.
+class PocketmageIO {
+public:
+  enum Op       : uint8_t { READ, WRITE, APPEND, LIST, STAT };
+  enum Priority : uint8_t { URGENT, NORMAL, PREFETCH, PRIORITY_COUNT };
+
+  struct Result {
+    Op     op;
+    String path;
+    bool   ok     = false;
+    String data;                           // READ: bytes read
+    size_t size   = 0;                     // READ / WRITE / APPEND: bytes moved, STAT: file size
+    bool   isDir  = false;                 // STAT
+    time_t mtime  = 0;                     // STAT
+    PocketmageDirCache::ListingPtr entries;   // LIST
+  };
+  using Callback = std::function<void(const Result&)>;
+
+  struct Job {
+    Result        result;
+    Priority      priority = NORMAL;
+    size_t        offset   = 0;            // READ: first byte
+    size_t        length   = 0;            // READ: 0 reads to the end
+    String        payload;                 // WRITE / APPEND
+    Callback      onDone;
+    volatile bool started  = false;
+    volatile bool done     = false;
+  };
+  using Ticket = std::shared_ptr<Job>;
+
+  void   begin();                          // called by setupSD(), the task starts on the first request
+
+  Ticket read(const String& path, size_t offset = 0, size_t length = 0, Priority p = NORMAL,
+              Callback onDone = nullptr);
+  Ticket write(const String& path, const String& data, Priority p = NORMAL, Callback onDone = nullptr);
+  Ticket append(const String& path, const String& data, Priority p = NORMAL, Callback onDone = nullptr);
+  Ticket list(const String& dir, Priority p = NORMAL, Callback onDone = nullptr);
+  Ticket stat(const String& path, Priority p = NORMAL, Callback onDone = nullptr);
+
+  static bool ready(const Ticket& t) { return t && t->done; }
+  // Blocks until t completes, moving it to the front if it hasn't started.
+  // Never call it while holding an SDSession or SDLock, the storage task needs the card.
+  bool   wait(const Ticket& t, uint32_t timeoutMs = UINT32_MAX);
+  void   cancel(const Ticket& t);          // drops t if it hasn't started, it completes with ok = false
+  size_t pending();
 
 private:
+  Ticket submit_(Ticket job);
+  Ticket next_();
+  void   run_(Job& job);
+  void   finish_(Job& job);
+  bool   unqueue_(const Ticket& t);
 
-  static constexpr const char*  tag               = "MAGE_SD";
-
-  String editingFile_ = "";
-  String filesList_[MAX_FILES];
-  String workingFile_ = "";
+  static void taskEntry_(void* parameter);
 
-  uint8_t                       fileIndex_        = 0;
-  String                        excludedFiles_[3] = { "/temp.txt", "/settings.txt", "/tasks.txt" };
-
-  // Flags / counters
-  bool                          noSD_              = false;
+  std::deque<Ticket> queues_[PRIORITY_COUNT];
+  SemaphoreHandle_t  lock_ = NULL;         // guards queues_
+  TaskHandle_t       task_ = NULL;
 };
 
 void setupSD();
-PocketmageSDAUTO& PM_SDAUTO();
-PocketmageSDMMC& PM_SDMMC();
-PocketmageSDSPI& PM_SDSPI();
+// global_fs as a PocketmageFs, and the storage service on top of it. Hold an SDSession around
+// calls, PocketmageSD does. Writes through PM_STORE() invalidate PM_DIRS() on their own.
+PocketmageFs& PM_FS();
+PocketmageStore& PM_STORE();
+PocketmageMetaStore& PM_META();
+PocketmageDirCache& PM_DIRS();
+PocketmageIO& PM_IO();
+PocketmageSD& PM_SDAUTO();
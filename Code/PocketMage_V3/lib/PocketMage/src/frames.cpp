@@ -77,7 +77,9 @@ Frames Class:
     if invert = 1, text will be displayed in dark mode
     if overlap = 1, frame with cover any contect behind frame
     frames uses a TextSource as a source for drawn text, which can be defined as either
-    a constant array of char, a FixedArenaSource for dynamic text content, or a bitmap for images
+    a constant array of char, a FixedArenaSource for dynamic text content, a RingArenaSource for
+    append-forever history (oldest lines are evicted), a FileTextSource for text files on SD
+    too large for RAM, or a bitmap for images
     - an example of using frames can be seen in calc.cpp (https://github.com/ashtf8/PocketMage-Calc/tree/main/src/CALC_APP)
   
   Setup:
@@ -85,61 +87,158 @@ Frames Class:
     frames point to 3 different types of sources: a fixed arena source (dynamic content), a progremmem table (static text), and a bitmap (static image)
   
   Usage:
-    einkFramesDynamic(std::vector<Frame*> &frames, bool doFull_) // draws all frames in std::vector<Frame *> frames
+    einkFramesDynamic(std::vector<Frame*> &frames, bool doFull_) // draws changed frames in std::vector<Frame *> frames, doFull_ draws all of them
+    frame.dirty = true; // force a redraw after changing something the frame can't detect (geometry, box, invert, bitmap)
     updateScroll(Frame *currentFrameState,int prevScroll,int currentScroll, bool reset) // updates individual frame's scroll from scrollDynamic and prevScrollDynamic
 
     frames.clear(); // remove all frames stored in std::vector<frame *> frames
     frames.push_back(frame *); // add the frames you want to draw NOTE: frames pushed back earlier will be drawn over if new frames have overlap set to true
     CurrentFrameState = &frame; // point to current frame you want to control, can switch at any point to control different frames
 
-    frameLines.pushLine(s.c_str(), (uint16_t)s.length(), flag); // push line to a dynamic text source, flag currently not implemented
+    frameLines.pushLine(s.c_str(), (uint16_t)s.length(), flag); // push line to a dynamic text source, flag is LF_NONE, LF_RIGHT or LF_CENTER
 
     std::vector<String> sourceToVector(const TextSource* src); // export frame text source to std::vector<String> for compatibility 
 */
 
 
-#pragma region helpers
-///////////////////////////// HELPER FUNCTIONS
-// align numbers to be divisible by 8, useful for partial windows (y & h must be divisible by 8 with GxEPD2 with rotation == 3)
-int alignDown8(int v) { return v - (v % 8); }
-int alignUp8(int v)   { return (v % 8) ? v + (8 - (v % 8)) : v; }
-
-size_t sliceThatFits(const char* s, size_t n, int maxTextWidth) {
-  if (!s || n == 0) return 0;
-
-  int16_t x1, y1; uint16_t w, h;
-  static char buf[256]; 
-  const size_t cap = sizeof(buf) - 1;
-
-  size_t best = 0, lastSpace = SIZE_MAX;
-  size_t i = 0;
-  size_t len = 0;
-
-  while (i < n && len < cap) {
-    char c = s[i];
-
-    // newline: either end before it, or consume 1 char if it's first
-    if (c == '\n' || c == '\r') return (best > 0) ? best : 1;
+#pragma region fileSource
+///////////////////////////// SD FILE TEXT SOURCE
+static constexpr const char* TAG = "FRAMES";
 
-    if (c == ' ') lastSpace = i;
+// INDEX THE FILE IN ONE BUFFERED PASS !!
+bool FileTextSource::open(fs::FS& fs, const char* path) {
+  close();
 
-    buf[len++] = c;
-    buf[len] = '\0';
+  SDSession session;
 
-    display.getTextBounds(buf, 0, 0, &x1, &y1, &w, &h);
-    if ((int)w > maxTextWidth) break;
+  ulong start = millis();
+  file_ = fs.open(path, FILE_READ);
+  if (!file_ || file_.isDirectory()) {
+    ESP_LOGE(TAG, "Can't open text source: %s", path);
+    close();
+    return false;
+  }
+  fileSize_ = file_.size();
+
+  // a new page starts at the first line that would push the current one past its buffer
+  anchors_.push_back({ 0, 0 });
+  uint32_t line = 0, lineStart = 0, groupStart = 0, groupLines = 0;
+  auto endLine = [&](uint32_t lineEnd) {
+    if (groupLines > 0 && lineEnd - groupStart > FILE_SOURCE_PAGE_BYTES - 1) {
+      anchors_.push_back({ line, lineStart });
+      groupStart = lineStart;
+      groupLines = 0;
+    }
+    groupLines++;
+    line++;
+    lineStart = lineEnd;
+  };
+
+  std::vector<char> chunk(FILE_SOURCE_PAGE_BYTES);
+  uint32_t pos = 0;
+  while (pos < fileSize_) {
+    int n = file_.read((uint8_t*)chunk.data(), chunk.size());
+    if (n <= 0) break;
+    for (int k = 0; k < n; ++k) {
+      ++pos;
+      if (chunk[k] == '\n') endLine(pos);
+    }
+  }
+  if (lineStart < pos) endLine(pos);  // last line without a newline
 
-    best = i + 1;
-    ++i;
+  nLines_ = line;
+  version_++;
+  ESP_LOGI(TAG, "Indexed %s: %u lines, %u pages in %lu ms", path, (unsigned)nLines_,
+           (unsigned)anchors_.size(), millis() - start);
+  return true;
+}
+void FileTextSource::close() {
+  if (file_) {
+    SDLock lock;
+    file_.close();
+  }
+  file_     = fs::File();
+  fileSize_ = 0;
+  nLines_   = 0;
+  anchors_.clear();
+  for (Page& p : pages_) p.id = -1;
+  version_++;
+}
+// CACHED PAGE, DECODED FROM THE CARD ON A MISS !!
+const FileTextSource::Page& FileTextSource::page(size_t id) const {
+  Page* victim = &pages_[0];
+  for (Page& p : pages_) {
+    if (p.id == (int32_t)id) {
+      hits_++;
+      p.lastUse = ++useClock_;
+      return p;
+    }
+    if (p.id < 0 || (victim->id >= 0 && p.lastUse < victim->lastUse)) victim = &p;
+  }
+  misses_++;
+
+  Page& p = *victim;
+  p.id      = (int32_t)id;
+  p.lastUse = ++useClock_;
+  p.data.resize(FILE_SOURCE_PAGE_BYTES);
+  p.starts.clear();
+  p.lens.clear();
+
+  const uint32_t from = anchors_[id].offset;
+  const uint32_t to   = (id + 1 < anchors_.size()) ? anchors_[id + 1].offset : fileSize_;
+  size_t n = min((size_t)(to - from), (size_t)FILE_SOURCE_PAGE_BYTES - 1);
+  int got;
+  {
+    // line() lands here on every miss, often from the render task, so the read takes the card
+    SDSession session;
+    file_.seek(from);
+    got = file_.read((uint8_t*)p.data.data(), n);
+  }
+  n = (got > 0) ? (size_t)got : 0;
+
+  // split on newlines in place so every line is NUL-terminated
+  auto addLine = [&](size_t start, size_t end) {
+    size_t len = end - start;
+    if (len && p.data[start + len - 1] == '\r') --len;
+    p.data[start + len] = '\0';
+    p.starts.push_back((uint16_t)start);
+    p.lens.push_back((uint16_t)len);
+  };
+  size_t lineStart = 0;
+  for (size_t j = 0; j < n; ++j) {
+    if (p.data[j] == '\n') {
+      addLine(lineStart, j);
+      lineStart = j + 1;
+    }
   }
+  if (lineStart < n) addLine(lineStart, n);
+  return p;
+}
+LineView FileTextSource::line(size_t i) const {
+  if (i >= nLines_) return { "", 0, LF_NONE };
+
+  // last page whose first line is <= i
+  auto it = std::upper_bound(anchors_.begin(), anchors_.end(), (uint32_t)i,
+                             [](uint32_t v, const Anchor& a) { return v < a.line; });
+  const size_t id = (it - anchors_.begin()) - 1;
+  const Page& p = page(id);
+
+  const size_t k = i - anchors_[id].line;
+  if (k >= p.starts.size()) return { "", 0, LF_NONE };
+  return { p.data.data() + p.starts[k], p.lens[k], LF_NONE };
+}
+#pragma endregion
 
-  const bool overflowed = (i < n) || (len >= cap);
-  if (best == 0) return (n ? 1 : 0);
+#pragma region helpers
+///////////////////////////// HELPER FUNCTIONS
+// align numbers to be divisible by 8, useful for partial windows (y & h must be divisible by 8 with GxEPD2 with rotation == 3)
+int alignDown8(int v) { return v - (v % 8); }
+int alignUp8(int v)   { return (v % 8) ? v + (8 - (v % 8)) : v; }
 
-  if (overflowed && lastSpace != SIZE_MAX && lastSpace + 1 <= best) {
-    return lastSpace + 1;
-  }
-  return best;
+// Longest prefix of s that fits in maxTextWidth, preferring to break after a space.
+// In the current EINK font, see sliceToWidth().
+size_t sliceThatFits(const char* s, size_t n, int maxTextWidth) {
+  return sliceToWidth(EINK().getCurrentFont(), s, n, maxTextWidth);
 }
 // GET TOTAL LINES OF SOURCE !!
 inline long totalLines(const Frame& frame) {
@@ -164,6 +263,55 @@ inline size_t trimCRLF(const char* s, size_t n) {
   return n;
 }
 
+// FIT THE WRAP CACHE TO THE VISIBLE LINES, DROPPING IT IF SOURCE, FONT OR WIDTH CHANGED !!
+void validateWrapCache(Frame& frame, int maxTextWidth, long startLine, long endLine) {
+  const GFXfont* font    = EINK().getCurrentFont();
+  const uint32_t version = frame.source->version();
+  const uint32_t base    = (uint32_t)max(0L, startLine);
+  const size_t   count   = (endLine > (long)base) ? (size_t)(endLine - base) : 0;
+  const bool     valid   = frame.wrapSource == frame.source && frame.wrapVersion == version &&
+                           frame.wrapFont == font && frame.wrapWidth == maxTextWidth;
+  if (valid && frame.wrapBase == base && frame.wrapFirst.size() == count) return;
+
+  // lines still in view keep their rows, lines scrolled out are dropped
+  std::vector<Frame::WrapSlice> slices;
+  std::vector<int32_t>          first(count, -1);
+  if (valid) {
+    for (size_t k = 0; k < count; ++k) {
+      const uint32_t line = base + k;
+      if (line < frame.wrapBase || line - frame.wrapBase >= frame.wrapFirst.size()) continue;
+      const int32_t row = frame.wrapFirst[line - frame.wrapBase];
+      if (row < 0) continue;
+      first[k] = (int32_t)slices.size();
+      for (size_t r = row; r < frame.wrapSlices.size() && frame.wrapSlices[r].line == line; ++r)
+        slices.push_back(frame.wrapSlices[r]);
+    }
+  }
+  frame.wrapSlices.swap(slices);
+  frame.wrapFirst.swap(first);
+  frame.wrapBase    = base;
+  frame.wrapSource  = frame.source;
+  frame.wrapVersion = version;
+  frame.wrapFont    = font;
+  frame.wrapWidth   = maxTextWidth;
+}
+// INDEX OF THE FIRST WRAPPED ROW OF A VISIBLE SOURCE LINE, WRAPPING IT ON FIRST USE !!
+size_t wrapLine(Frame& frame, long line, const LineView& lv, size_t effLen, int maxTextWidth) {
+  int32_t& cached = frame.wrapFirst[line - frame.wrapBase];
+  if (cached >= 0) return (size_t)cached;
+
+  const size_t first = frame.wrapSlices.size();
+  size_t pos = 0;
+  while (pos < effLen) {
+    size_t take = sliceThatFits(lv.ptr + pos, effLen - pos, maxTextWidth);
+    if (take == 0) break;
+    frame.wrapSlices.push_back({ (uint32_t)line, (uint16_t)pos, (uint16_t)take });
+    pos += take;
+  }
+  cached = (int32_t)first;
+  return first;
+}
+
 // MAKE SURE CHOICE IS VISIBLE IN FRAME --
 void ensureChoiceVisible(Frame& frame) {
   long T = frame.source ? (long)frame.source->size() : 0L;
@@ -184,11 +332,10 @@ void resetScroll(Frame& frame) {
   frame.scroll = tl > ml ? (tl - ml) : 0;
   frame.prevScroll = -1;
 }
-// GET CLEANED STRING FROM FRAME CHOICE -- NOTE: remove ~C~ and ~R~ in refactor to lineview flages
+// GET CLEANED STRING FROM FRAME CHOICE !!
 String frameChoiceString(const Frame& f) {
   LineView lv = f.source->line(f.choice);
   String s(lv.ptr, lv.len);
-  if (s.startsWith("~C~") || s.startsWith("~R~")) s.remove(0, 3);
   s.trim();
   return s;   
 }
@@ -208,149 +355,206 @@ std::vector<String> sourceToVector(const TextSource* src) {
 #pragma endregion
 
 ///////////////////////////// DRAWING FUNCTIONS
-// DRAW ALL FRAMES STORED WITHIN TOTAL FRAME BOUNDING BOX -- NOTE: remove ~C~ and ~R~ with switch to lineview flags
-void einkFramesDynamic(std::vector<Frame*> &frames, bool doFull_) {
-  if (frames.empty()) return;
+// panel region in pixels, x1/y1 exclusive
+struct FrameRect { int x0, y0, x1, y1; };
 
-  // compute union window of all frames
-  int minX =  32767, minY =  32767;
-  int maxX = -32768, maxY = -32768;
-  for (Frame* frame : frames) {
-    if (!frame) continue;
-    const int width = display.width()  - frame->left  - frame->right;
-    const int height = display.height() - frame->top   - frame->bottom;
-    if (width <= 0 || height <= 0) continue;
-    if (frame->left < minX) minX = frame->left;
-    if (frame->top  < minY) minY = frame->top;
-    if (frame->left + width > maxX) maxX = frame->left + width;
-    if (frame->top  + height > maxY) maxY = frame->top  + height;
-  }
-  if (minX > maxX || minY > maxY) return;
+// DRAW ONE FRAME INTO THE CURRENT PAGE !!
+static void drawFrame(Frame* frame, bool doFull_) {
+  if (!frame || (!frame->source && !frame->bitmap)) return;
 
-  const int frameX = minX;
-  const int frameY = alignDown8(minY);
-  const int frameW = alignUp8(maxX - minX);
-  const int frameH = alignDown8(maxY - frameY);
+  const int frameW = display.width()  - frame->left - frame->right;
+  const int frameH = display.height() - frame->top  - frame->bottom;
+  if (frameW <= 0 || frameH <= 0) return;
 
-  EINK().setTXTFont(EINK().getCurrentFont());
+  // if frame overlaps or is inverted, fill box with proper color
+  if (frame->invert || frame->overlap) {
+    display.fillRect(frame->left, frame->top, frameW, frameH,
+                    frame->invert ? GxEPD_BLACK : GxEPD_WHITE);
+  }
 
-  display.setPartialWindow(frameX, frameY, frameW, frameH);
-  display.firstPage();
-  do {
-    if (doFull_) {
-      display.fillRect(frameX, frameY, frameW, frameH, GxEPD_WHITE);
+  if (frame->box) {
+    //Serial.println("drawing box!");
+    if (frameW > 2 && frameH > 2) {
+      drawFrameBox(frame->left + 1, frame->top + 1, frameW - 2, frameH - 2,frame->invert);
     }
-    //Serial.println("Drawing Text!");
-    for (Frame* frame : frames) {
-      if (!frame || (!frame->source && !frame->bitmap)) continue;
-
-      const int frameW = display.width()  - frame->left - frame->right;
-      const int frameH = display.height() - frame->top  - frame->bottom;
-      if (frameW <= 0 || frameH <= 0) continue;
-
-      // if frame overlaps or is inverted, fill box with proper color
-      if (frame->invert || frame->overlap) {
-        display.fillRect(frame->left, frame->top, frameW, frameH,
-                        frame->invert ? GxEPD_BLACK : GxEPD_WHITE);
-      }
-
-      if (frame->box) {
-        //Serial.println("drawing box!");
-        if (frameW > 2 && frameH > 2) {
-          drawFrameBox(frame->left + 1, frame->top + 1, frameW - 2, frameH - 2,frame->invert);
-        }
-      }
-      if (frame->bitmap) {
-
-        if (frame->bitmapW <= frameW && frame->bitmapH <= frameH) {
-
-          const uint16_t bitColor = frame->invert ? GxEPD_WHITE : GxEPD_BLACK;
-          if (frame->bitmapW <= frameW && frame->bitmapH <= frameH) {
-              int x = frame->left + (frameW - frame->bitmapW) / 2;
-              int y = frame->top  + (frameH - frame->bitmapH) / 2;
-              display.drawBitmap(x, y, frame->bitmap, frame->bitmapW, frame->bitmapH, bitColor);
-          }
-
-        }
-
-        continue;
-      }
-      const int lineStride = EINK().getFontHeight() + EINK().getLineSpacing();
-
-      frame->maxLines = (lineStride > 1) ? (frameH / lineStride) - 1 : 0;
-      if (frame->maxLines <= 0) continue;
+  }
+  if (frame->bitmap) {
 
-      const long total  = frame->source ? (long)frame->source->size() : 0L;
-      clampScroll(*frame);
+    if (frame->bitmapW <= frameW && frame->bitmapH <= frameH) {
 
-      if (frame == CurrentFrameState && frame->choice >= 0) {
-        ensureChoiceVisible(*frame);
+      const uint16_t bitColor = frame->invert ? GxEPD_WHITE : GxEPD_BLACK;
+      if (frame->bitmapW <= frameW && frame->bitmapH <= frameH) {
+          int x = frame->left + (frameW - frame->bitmapW) / 2;
+          int y = frame->top  + (frameH - frame->bitmapH) / 2;
+          display.drawBitmap(x, y, frame->bitmap, frame->bitmapW, frame->bitmapH, bitColor);
       }
-      // initialize lastTotal on first draw
-      if (frame->lastTotal < 0) frame->lastTotal = total;
-
-      // remember if user was pinned to bottom before we adjust
-      const bool wasPinnedToBottom = (frame->scroll == 0);
 
-      // if maxLines shrank or list shrank, clamp scroll
-      clampScroll(*frame);
+    }
 
-      // if user is at bottom, keep them there when lines grow
-      if (wasPinnedToBottom) frame->scroll = 0;
+    return;
+  }
+  const int lineStride = EINK().getFontHeight() + EINK().getLineSpacing();
 
-      // update last seen count
-      frame->lastTotal = total;
-      long startLine = 0, endLine = 0;
-      // now get the visible range with the reconciled values
+  frame->maxLines = (lineStride > 1) ? (frameH / lineStride) - 1 : 0;
+  if (frame->maxLines <= 0) return;
 
+  const long total  = frame->source ? (long)frame->source->size() : 0L;
+  clampScroll(*frame);
 
-      const int maxTextWidth = frameW;
-      int outLine = 0;
-      getVisibleRange(frame, total, startLine, endLine); 
-      // force the visible window to the selected line when only one line fits
-      if (frame->maxLines <= 1 && frame->choice >= 0 && frame->choice < total) {
-        startLine = frame->choice;
-        endLine   = frame->choice + 1; 
-      }
-      for (long line = startLine; line < endLine; ++line) {
-        LineView lv = frame->source->line(line);
-        size_t effLen = trimCRLF(lv.ptr, lv.len);
-        if (effLen == 0) { ++outLine; continue; }
+  if (frame == CurrentFrameState && frame->choice >= 0) {
+    ensureChoiceVisible(*frame);
+  }
+  // initialize lastTotal on first draw
+  if (frame->lastTotal < 0) frame->lastTotal = total;
 
-        const bool right  = (lv.flags & LF_RIGHT)  != 0;
-        const bool center = (lv.flags & LF_CENTER) != 0;
+  // remember if user was pinned to bottom before we adjust
+  const bool wasPinnedToBottom = (frame->scroll == 0);
 
-        const bool isSelectedLine = (frame == CurrentFrameState) && (frame->choice == line);
-        bool firstSlice = true;
+  // if maxLines shrank or list shrank, clamp scroll
+  clampScroll(*frame);
 
-        size_t pos = 0;
-        while (pos < effLen) {
-          size_t take = sliceThatFits(lv.ptr + pos, effLen - pos, maxTextWidth);
-          if (take == 0) break;
+  // if user is at bottom, keep them there when lines grow
+  if (wasPinnedToBottom) frame->scroll = 0;
 
-          String toPrint;
-          if (right)       toPrint = "~R~";
-          else if (center) toPrint = "~C~";
+  // update last seen count
+  frame->lastTotal = total;
+  long startLine = 0, endLine = 0;
+  // now get the visible range with the reconciled values
 
 
+  const int maxTextWidth = frameW;
+  int outLine = 0;
+  getVisibleRange(frame, total, startLine, endLine); 
+  // force the visible window to the selected line when only one line fits
+  if (frame->maxLines <= 1 && frame->choice >= 0 && frame->choice < total) {
+    startLine = frame->choice;
+    endLine   = frame->choice + 1; 
+  }
+  validateWrapCache(*frame, maxTextWidth, startLine, endLine);
+  for (long line = startLine; line < endLine; ++line) {
+    LineView lv = frame->source->line(line);
+    size_t effLen = trimCRLF(lv.ptr, lv.len);
+    if (effLen == 0) { ++outLine; continue; }
+
+    const bool isSelectedLine = (frame == CurrentFrameState) && (frame->choice == line);
+    bool firstSlice = true;
+
+    // rows come from the wrap cache, only lines never seen at this width get sliced
+    const size_t firstRow = wrapLine(*frame, line, lv, effLen, maxTextWidth);
+    for (size_t row = firstRow;
+         row < frame->wrapSlices.size() && frame->wrapSlices[row].line == (uint32_t)line; ++row) {
+      const Frame::WrapSlice& slice = frame->wrapSlices[row];
+
+      // draw with the current visual row index, the selected line gets a "<" marker
+      drawLineInFrame(lv.ptr + slice.off, slice.len, lv.flags, isSelectedLine && firstSlice,
+                      outLine++, *frame, 0, false, !doFull_);
+
+      firstSlice = false;
+    }
+  }
+}
+// PANEL RECT COVERED BY A FRAME, 8-ALIGNED FOR PARTIAL WINDOWS !!
+static bool frameRect(const Frame* frame, FrameRect& r) {
+  const int width  = display.width()  - frame->left - frame->right;
+  const int height = display.height() - frame->top  - frame->bottom;
+  if (width <= 0 || height <= 0) return false;
+  r.x0 = alignDown8(frame->left);
+  r.y0 = alignDown8(frame->top);
+  r.x1 = min((int)display.width(),  alignUp8(frame->left + width));
+  r.y1 = min((int)display.height(), alignUp8(frame->top  + height));
+  return true;
+}
+// TRUE IF THE FRAME CHANGED SINCE IT WAS LAST SENT TO THE PANEL !!
+bool frameIsDirty(const Frame& frame) {
+  if (frame.dirty) return true;
+  if (frame.scroll != frame.drawnScroll || frame.choice != frame.drawnChoice) return true;
+  if (frame.source != frame.drawnSource) return true;
+  return frame.source && frame.source->version() != frame.drawnVersion;
+}
+// REMEMBER WHAT WAS SENT SO UNCHANGED FRAMES ARE SKIPPED NEXT TIME !!
+static void markFrameDrawn(Frame& frame) {
+  frame.dirty        = false;
+  frame.drawnScroll  = frame.scroll;
+  frame.drawnChoice  = frame.choice;
+  frame.drawnSource  = frame.source;
+  frame.drawnVersion = frame.source ? frame.source->version() : 0;
+}
+// MERGE RECTS THAT OVERLAP OR TOUCH SO EACH PANEL UPDATE COVERS AS MUCH AS POSSIBLE !!
+static void mergeRects(std::vector<FrameRect>& rects) {
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (size_t i = 0; i < rects.size() && !merged; ++i) {
+      for (size_t j = i + 1; j < rects.size(); ++j) {
+        FrameRect& a = rects[i];
+        const FrameRect& b = rects[j];
+        if (a.x0 > b.x1 || b.x0 > a.x1 || a.y0 > b.y1 || b.y0 > a.y1) continue;
+        a.x0 = min(a.x0, b.x0); a.y0 = min(a.y0, b.y0);
+        a.x1 = max(a.x1, b.x1); a.y1 = max(a.y1, b.y1);
+        rects.erase(rects.begin() + j);
+        merged = true;
+        break;
+      }
+    }
+  }
+}
+// DRAW FRAMES THAT CHANGED, ONE PARTIAL WINDOW PER MERGED DIRTY REGION !!
+// doFull_ redraws every frame in a single window covering all of them
+void einkFramesDynamic(std::vector<Frame*> &frames, bool doFull_) {
+  if (frames.empty()) return;
 
-          toPrint.concat(String(lv.ptr + pos).substring(0, take));
+  // collect dirty regions, or the union of all frames when doing a full draw
+  std::vector<FrameRect> rects;
+  FrameRect all = { 32767, 32767, -32768, -32768 };
+  for (Frame* frame : frames) {
+    FrameRect r;
+    if (!frame || !frameRect(frame, r)) continue;
+    if (doFull_) {
+      all.x0 = min(all.x0, r.x0); all.y0 = min(all.y0, r.y0);
+      all.x1 = max(all.x1, r.x1); all.y1 = max(all.y1, r.y1);
+    } else if (frameIsDirty(*frame)) {
+      rects.push_back(r);
+    }
+  }
+  if (doFull_ && all.x0 < all.x1 && all.y0 < all.y1) rects.push_back(all);
+  if (rects.empty()) return;
+  mergeRects(rects);
 
-          if (isSelectedLine && firstSlice) {
-            toPrint = toPrint + "<";
-          }
-          // draw with the current visual row index
-          drawLineInFrame(toPrint, outLine++, *frame, 0, false,!doFull_);
+  EINK().setTXTFont(EINK().getCurrentFont());
 
-          pos += take;
-          firstSlice = false;
-        }
+  // a queued full frame would land on top of these windows, let it go out first
+  EINK().waitForFlush();
+  EINK().lockPanel();
+  for (const FrameRect& win : rects) {
+    display.setPartialWindow(win.x0, win.y0, win.x1 - win.x0, win.y1 - win.y0);
+    display.firstPage();
+    do {
+      if (doFull_) {
+        display.fillRect(win.x0, win.y0, win.x1 - win.x0, win.y1 - win.y0, GxEPD_WHITE);
+      }
+      // the window's buffer starts blank, so every frame it touches is drawn in stacking order
+      for (Frame* frame : frames) {
+        FrameRect r;
+        if (!frame || !frameRect(frame, r)) continue;
+        if (r.x0 >= win.x1 || win.x0 >= r.x1 || r.y0 >= win.y1 || win.y0 >= r.y1) continue;
+        drawFrame(frame, doFull_);
       }
-   
+    } while (display.nextPage());
+    EINK().windowShown();
+  }
+  EINK().unlockPanel();
+
+  // frames fully inside a sent window are now up to date
+  for (Frame* frame : frames) {
+    FrameRect r;
+    if (!frame || !frameRect(frame, r)) continue;
+    for (const FrameRect& win : rects) {
+      if (r.x0 >= win.x0 && r.x1 <= win.x1 && r.y0 >= win.y0 && r.y1 <= win.y1) {
+        markFrameDrawn(*frame);
+        break;
       }
-    //Serial.println("Stopped Drawing Text!");
-  } while (display.nextPage());
-    //Serial.println("Done drawing frames!");
+    }
+  }
 }
 // DRAW BOX AROUND FRAME !!
 void drawFrameBox(int usableX, int usableY, int usableWidth, int usableHeight,bool invert) {
@@ -368,17 +572,17 @@ void drawFrameBox(int usableX, int usableY, int usableWidth, int usableHeight,bo
     display.drawFastVLine(usableX + usableWidth - 1, usableY, usableHeight, GxEPD_BLACK); // Right
   }
 }
-// DRAW SINGLE LINE IN FRAME -- NOTE: remove ~C~ and ~R~ with switch to lineview flags
-void drawLineInFrame(String &srcLine, int lineIndex, Frame &frame, int usableY, bool clearLine, bool isPartial) {
-    if (srcLine.length() == 0) return;
-    // get alignment and remove alignment marker
-    String line = srcLine;
-    bool rightAlign  = line.startsWith("~R~");
-    bool centerAlign = line.startsWith("~C~");
-    if (rightAlign || centerAlign) line.remove(0, 3);
-    int16_t x1, y1;
-    uint16_t lineWidth, lineHeight;
-    display.getTextBounds(line, 0, 0, &x1, &y1, &lineWidth, &lineHeight);
+// DRAW SINGLE LINE IN FRAME !!
+// text is drawn straight from the source, len bytes with alignment taken from LineFlags
+void drawLineInFrame(const char* text, size_t len, uint8_t flags, bool choiceMarker, int lineIndex, Frame &frame, int usableY, bool clearLine, bool isPartial) {
+    if (!text || len == 0) return;
+    bool rightAlign  = (flags & LF_RIGHT)  != 0;
+    bool centerAlign = (flags & LF_CENTER) != 0;
+    InkBounds bounds(EINK().getCurrentFont());
+    bounds.add(text, len);
+    if (choiceMarker) bounds.add('<');
+    int16_t x1 = bounds.x1(), y1 = bounds.y1();
+    uint16_t lineWidth = bounds.width();
     int cursorX = computeCursorX(frame, rightAlign, centerAlign, x1, lineWidth);
     // set yRaw to frame top + spaces taken by all previous lines
     int yRaw = frame.top + lineIndex * (EINK().getFontHeight() + EINK().getLineSpacing());
@@ -395,7 +599,8 @@ void drawLineInFrame(String &srcLine, int lineIndex, Frame &frame, int usableY,
     }
     display.setCursor(cursorX, yDraw);
     frame.invert ? display.setTextColor(GxEPD_WHITE) : display.setTextColor(GxEPD_BLACK);
-    display.print(line);
+    display.write((const uint8_t*)text, len);
+    if (choiceMarker) display.write('<');
 }
 
 ///////////////////////////// FRAME SCROLL FUNCTIONS
@@ -486,16 +691,15 @@ void oledScrollFrame() {
   const int rowStep  = 4;
   const int baseY    = 28;
 
+  const FontMetrics& metrics = EINK().fontMetrics(EINK().getCurrentFont());
   for (long int i = previewBottom; i >= previewTop && i >= 0; --i) {
     if (i < 0 || i >= count) continue;
 
-    int16_t x1, y1;
-    uint16_t charWidth, charHeight;
     LineView lv = CurrentFrameState->source->line(i);
-    String line = String(lv.ptr).substring(0, lv.len);
+    uint16_t charWidth;
 
-    if (line.startsWith("    ")) {
-      display.getTextBounds(line.substring(4), 0, 0, &x1, &y1, &charWidth, &charHeight);
+    if (lv.len >= 4 && strncmp(lv.ptr, "    ", 4) == 0) {
+      charWidth = metrics.textWidth(lv.ptr + 4, lv.len - 4);
       int lineWidth = map(charWidth, 0, 320, 0, 49);
       lineWidth = constrain(lineWidth, 0, 49);
 
@@ -506,7 +710,7 @@ void oledScrollFrame() {
         // u8g2.drawBox(68, boxY, lineWidth, 2);
       }
     } else {
-      display.getTextBounds(line, 0, 0, &x1, &y1, &charWidth, &charHeight);
+      charWidth = metrics.textWidth(lv.ptr, lv.len);
       int lineWidth = map(charWidth, 0, 320, 0, 56);
       lineWidth = constrain(lineWidth, 0, 56);
 
@@ -535,7 +739,7 @@ void oledScrollFrame() {
 
       if (pLine.length() > 0) {
         u8g2.setFont(u8g2_font_ncenB10_tr);
-        u8g2.drawStr((u8g2.getWidth() - u8g2.getUTF8Width(pLine.substring(3).c_str())) / 2, 24, pLine.substring(3).c_str());
+        u8g2.drawStr((u8g2.getWidth() - u8g2.getUTF8Width(pLine.c_str())) / 2, 24, pLine.c_str());
       }
     }
   } else {
@@ -10,10 +10,15 @@
 
 static constexpr const char* tag = "EINK";
 
-GxEPD2_BW<GxEPD2_310_GDEQ031T10, GxEPD2_310_GDEQ031T10::HEIGHT> display(GxEPD2_310_GDEQ031T10(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY));
+DisplayT display(PanelT(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY));
 
 TaskHandle_t einkHandlerTaskHandle = NULL; // E-Ink handler task
 
+// Frames waiting for / being pushed by the flush task, panel layout
+static uint8_t flushBuffers[2][DisplayT::BUFFER_BYTES];
+// What the panel currently shows, panel layout
+static uint8_t shownBuffer[DisplayT::BUFFER_BYTES];
+
 // Fast full update flag for e-ink
 volatile bool GxEPD2_310_GDEQ031T10::useFastFullUpdate = true;
 
@@ -23,27 +28,255 @@ static PocketmageEink pm_eink(display);
 // Access for other apps 
 PocketmageEink& EINK() { return pm_eink; }
 
+// ===================== back buffer =====================
+void PipelinedDisplay::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  Base::drawPixel(x, y, color);
+
+  // SAME CLIPPING AND ROTATION AS GxEPD2_BW, BUT INTO A FULL SCREEN BUFFER
+  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+  int16_t t;
+  switch (getRotation()) {
+    case 1: t = x; x = y; y = t; x = PanelT::WIDTH - x - 1; break;
+    case 2: x = PanelT::WIDTH - x - 1; y = PanelT::HEIGHT - y - 1; break;
+    case 3: t = x; x = y; y = t; y = PanelT::HEIGHT - y - 1; break;
+  }
+  if ((x < pwX_) || (x >= pwX_ + pwW_) || (y < pwY_) || (y >= pwY_ + pwH_)) return;
+
+  uint16_t i = x / 8 + y * (PanelT::WIDTH / 8);
+  if (color) backBuffer_[i] |= (1 << (7 - x % 8));
+  else       backBuffer_[i] &= (0xFF ^ (1 << (7 - x % 8)));
+}
+void PipelinedDisplay::fillScreen(uint16_t color) {
+  Base::fillScreen(color);
+
+  // ONLY THE CURRENT WINDOW, THE REST OF THE SCREEN IS STILL SHOWING
+  uint8_t data = (color == GxEPD_BLACK) ? 0x00 : 0xFF;
+  for (uint16_t y = pwY_; y < pwY_ + pwH_; y++) {
+    memset(backBuffer_ + y * (PanelT::WIDTH / 8) + pwX_ / 8, data, pwW_ / 8);
+  }
+}
+void PipelinedDisplay::setFullWindow() {
+  Base::setFullWindow();
+  pwX_ = 0; pwY_ = 0;
+  pwW_ = PanelT::WIDTH; pwH_ = PanelT::HEIGHT;
+}
+void PipelinedDisplay::setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  Base::setPartialWindow(x, y, w, h);
+
+  x = min(x, (uint16_t)width());
+  y = min(y, (uint16_t)height());
+  w = min(w, (uint16_t)(width() - x));
+  h = min(h, (uint16_t)(height() - y));
+  uint16_t t;
+  switch (getRotation()) {
+    case 1: t = x; x = y; y = t; t = w; w = h; h = t; x = PanelT::WIDTH - x - w; break;
+    case 2: x = PanelT::WIDTH - x - w; y = PanelT::HEIGHT - y - h; break;
+    case 3: t = x; x = y; y = t; t = w; w = h; h = t; y = PanelT::HEIGHT - y - h; break;
+  }
+  // BYTE ALIGNED LIKE GxEPD2
+  w += x % 8;
+  if (w % 8 > 0) w += 8 - w % 8;
+  x -= x % 8;
+  pwX_ = x; pwY_ = y; pwW_ = w; pwH_ = h;
+}
+
+// ===================== refresh pipeline =====================
+static void flushTaskEntry(void* parameter) { EINK().flushTask(); }
+
+void PocketmageEink::startFlushTask() {
+  if (flushTaskHandle_) return;
+  frameMutex_ = xSemaphoreCreateMutex();
+  panelMutex_ = xSemaphoreCreateMutex();
+  fontMutex_  = xSemaphoreCreateMutex();
+  pending_    = flushBuffers[0];
+  inflight_   = flushBuffers[1];
+
+  xTaskCreatePinnedToCore(
+    flushTaskEntry,          // Function name
+    "einkFlushTask",         // Task name
+    4096,                    // Stack size
+    NULL,                    // Parameters
+    1,                       // Priority
+    &flushTaskHandle_,       // Task handle
+    0                        // Core ID
+  );
+}
+void PocketmageEink::flushTask() {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // TAKE THE NEWEST FRAME, ANYTHING SUBMITTED WHILE WE PUSH IT WILL REPLACE IT IN pending_
+    xSemaphoreTake(frameMutex_, portMAX_DELAY);
+    if (!pendingReady_) {
+      xSemaphoreGive(frameMutex_);
+      continue;
+    }
+    // flushing_ goes up before pendingReady_ comes down, so waitForFlush() never sees both clear
+    flushing_ = true;
+    uint8_t* buf = pending_;
+    pending_ = inflight_;
+    inflight_ = buf;
+    bool slowFull = pendingSlow_;
+    ulong since = pendingSince_;
+    pendingReady_ = false;
+    pendingSlow_ = false;
+    xSemaphoreGive(frameMutex_);
+
+    lockPanel();
+    pushToPanel_(inflight_, slowFull);
+    unlockPanel();
+
+    uint32_t latency = millis() - since;
+    stats_.flushed++;
+    stats_.lastLatency = latency;
+    if (latency > stats_.maxLatency) stats_.maxLatency = latency;
+    ESP_LOGD(tag, "flushed frame in %u ms (%u dropped so far)", latency, stats_.dropped);
+    flushing_ = false;
+  }
+}
+void PocketmageEink::addGhostDebt_(const uint8_t* buffer, int b0, int y0, int b1, int y1) {
+  const int rowBytes = PanelT::WIDTH / 8;
+  for (int y = y0; y <= y1; y++) {
+    uint32_t* debtRow = ghostDebt_ + (y / GHOST_REGION_ROWS) * GHOST_COLS;
+    for (int b = b0; b <= b1; b++) {
+      size_t i = y * rowBytes + b;
+      uint8_t flipped = buffer[i] ^ shownBuffer[i];
+      if (flipped) debtRow[b / GHOST_REGION_BYTES] += __builtin_popcount(flipped);
+    }
+  }
+}
+uint32_t PocketmageEink::ghostDebtPercent_() const {
+  uint32_t worst = 0;
+  for (uint32_t d : ghostDebt_) worst = max(worst, d);
+  return worst * 100 / (GHOST_REGION_BYTES * 8 * GHOST_REGION_ROWS);
+}
+void PocketmageEink::pushToPanel_(const uint8_t* buffer, bool slowFull) {
+  const int rowBytes = PanelT::WIDTH / 8;
+  ulong start = millis();
+
+  // BOUNDING BOX OF PIXELS THAT DIFFER FROM THE PANEL, IN ROWS AND BYTE COLUMNS
+  int y0 = PanelT::HEIGHT, y1 = -1, b0 = rowBytes, b1 = -1;
+  if (shownValid_) {
+    for (int y = 0; y < PanelT::HEIGHT; y++) {
+      const uint8_t* row  = buffer + y * rowBytes;
+      const uint8_t* prev = shownBuffer + y * rowBytes;
+      if (memcmp(row, prev, rowBytes) == 0) continue;
+      if (y0 > y) y0 = y;
+      y1 = y;
+      for (int b = 0; b < b0; b++) {
+        if (row[b] ^ prev[b]) { b0 = b; break; }
+      }
+      for (int b = rowBytes - 1; b > b1; b--) {
+        if (row[b] ^ prev[b]) { b1 = b; break; }
+      }
+    }
+  }
+
+  // NOTHING CHANGED, LEAVE THE PANEL ALONE
+  if (shownValid_ && !slowFull && y1 < 0) {
+    stats_.unchanged++;
+    return;
+  }
+
+  // SLOW FULL UPDATE ONCE SOME REGION HAS FLIPPED TOO MANY PIXELS, OR WHEN SPECIFIED
+  if (shownValid_) addGhostDebt_(buffer, b0, y0, b1, y1);
+  uint32_t debt = ghostDebtPercent_();
+  if (debt > GHOSTING_DEBT_BUDGET) slowFull = true;
+
+  long changedArea = (long)(b1 - b0 + 1) * 8 * (y1 - y0 + 1);
+  bool partial = shownValid_ && !slowFull &&
+                 changedArea * 100 <= (long)PARTIAL_DIFF_MAX_PERCENT * PanelT::WIDTH * PanelT::HEIGHT;
+
+  // SMALL CHANGE, SEND ONLY THE WINDOW AROUND IT
+  if (partial) {
+    int16_t x = b0 * 8, w = (b1 - b0 + 1) * 8;
+    int16_t y = y0,     h = y1 - y0 + 1;
+    display_.epd2.writeImagePart(buffer, x, y, PanelT::WIDTH, PanelT::HEIGHT, x, y, w, h);
+    display_.epd2.refresh(x, y, w, h);
+    if (display_.epd2.hasFastPartialUpdate) {
+      display_.epd2.writeImagePartAgain(buffer, x, y, PanelT::WIDTH, PanelT::HEIGHT, x, y, w, h);
+    }
+    stats_.partial++;
+  }
+  // OTHERWISE SAME SEQUENCE AS GxEPD2_BW::display(false) IN FULL WINDOW MODE
+  else {
+    setFastFullRefresh(!slowFull);
+    display_.epd2.writeImage(buffer, 0, 0, PanelT::WIDTH, PanelT::HEIGHT);
+    display_.epd2.refresh(false);
+    if (display_.epd2.hasFastPartialUpdate) {
+      display_.epd2.writeImageAgain(buffer, 0, 0, PanelT::WIDTH, PanelT::HEIGHT);
+    }
+    if (slowFull) {
+      memset(ghostDebt_, 0, sizeof(ghostDebt_));
+      stats_.slowFull++;
+    } else {
+      stats_.fastFull++;
+    }
+  }
+  display_.epd2.powerOff();
+  display_.epd2.hibernate();
+
+  memcpy(shownBuffer, buffer, DisplayT::BUFFER_BYTES);
+  shownValid_ = true;
+
+  stats_.lastPushMs = millis() - start;
+  ESP_LOGI(tag, "%s refresh in %u ms, debt %u%% (slow %u, fast %u, partial %u)",
+           partial ? "partial" : (slowFull ? "slow full" : "fast full"),
+           stats_.lastPushMs, debt, stats_.slowFull, stats_.fastFull, stats_.partial);
+}
+void PocketmageEink::windowShown() {
+  uint16_t x, y, w, h;
+  display_.getWindow(x, y, w, h);
+  const uint8_t* src = display_.backBuffer();
+  if (shownValid_) addGhostDebt_(src, x / 8, y, (x + w) / 8 - 1, y + h - 1);
+  for (uint16_t row = y; row < y + h; row++) {
+    size_t i = row * (PanelT::WIDTH / 8) + x / 8;
+    memcpy(shownBuffer + i, src + i, w / 8);
+  }
+}
+void PocketmageEink::waitForFlush() {
+  if (!flushTaskHandle_) return;
+  while (pendingReady_ || flushing_) delay(5);
+}
+void PocketmageEink::lockPanel() {
+  if (panelMutex_) xSemaphoreTake(panelMutex_, portMAX_DELAY);
+}
+void PocketmageEink::unlockPanel() {
+  if (panelMutex_) xSemaphoreGive(panelMutex_);
+}
+
 // ===================== main functions =====================
 void PocketmageEink::refresh() {
-  // USE A SLOW FULL UPDATE EVERY N FAST UPDATES OR WHEN SPECIFIED
-  if ((partialCounter_ >= fullRefreshAfter_) || forceSlowFullUpdate_) {
-    forceSlowFullUpdate_ = false;
-    partialCounter_ = 0;
-    setFastFullRefresh(false);
-  } 
-  // OTHERWISE USE A FAST FULL UPDATE
+  // SLOW FULL UPDATE WHEN SPECIFIED, OTHERWISE THE FLUSH PATH DECIDES FROM THE GHOSTING DEBT
+  bool slowFull = forceSlowFullUpdate_;
+  forceSlowFullUpdate_ = false;
+
+  // NO FLUSH TASK YET (EARLY BOOT), PUSH IT NOW
+  if (!flushTaskHandle_) {
+    pushToPanel_(display_.backBuffer(), slowFull);
+  }
+  // OTHERWISE HAND THE FRAME OVER AND KEEP GOING, ONLY THE NEWEST PENDING FRAME IS PUSHED
   else {
-    setFastFullRefresh(true);
-    partialCounter_++;
+    xSemaphoreTake(frameMutex_, portMAX_DELAY);
+    stats_.submitted++;
+    if (pendingReady_) stats_.dropped++;
+    else pendingSince_ = millis();
+    memcpy(pending_, display_.backBuffer(), DisplayT::BUFFER_BYTES);
+    pendingSlow_ = pendingSlow_ || slowFull;
+    pendingReady_ = true;
+    xSemaphoreGive(frameMutex_);
+    xTaskNotifyGive(flushTaskHandle_);
   }
 
-  display_.display(false);
-
   display_.setFullWindow();
   display_.fillScreen(GxEPD_WHITE);
-  display_.hibernate();
 }
 void PocketmageEink::multiPassRefresh(int passes) {
+  // PASSES NEED THE PANEL TO THEMSELVES
+  waitForFlush();
+  lockPanel();
+  display_.setFullWindow();
+  windowShown();
   display_.display(false);
   if (passes > 0) {
     for (int i = 0; i < passes; i++) {
@@ -56,6 +289,7 @@ void PocketmageEink::multiPassRefresh(int passes) {
   display_.setFullWindow();
   display_.fillScreen(GxEPD_WHITE);
   display_.hibernate();
+  unlockPanel();
 }
 void PocketmageEink::setFastFullRefresh(bool setting) {
   PanelT::useFastFullUpdate = setting;
@@ -83,17 +317,72 @@ void PocketmageEink::drawStatusBar(const String& input) {
   display_.print(input);
 }
 void PocketmageEink::computeFontMetrics_() {
-  int16_t x1, y1; 
-  uint16_t charWidth, charHeight;
+  const FontMetrics& m = fontMetrics(currentFont_);
   // GET AVERAGE CHAR WIDTH
-  display_.getTextBounds("abcdefghijklmnopqrstuvwxyz", 0, 0, &x1, &y1, &charWidth, &charHeight);
-  charWidth = charWidth / 52; // check if intended 
+  uint16_t charWidth = m.avgCharWidth / 2; // check if intended 
   maxCharsPerLine_  = display_.width() / charWidth;
 
-  display_.getTextBounds("H", 0, 0, &x1, &y1, &charWidth, &charHeight);
-  fontHeight_ = charHeight;
+  fontHeight_ = m.capHeight;
   maxLines_   = (display_.height() - 26) / (fontHeight_ + lineSpacing_);
 }
+const FontMetrics& PocketmageEink::fontMetrics(const GFXfont* font) {
+  // PUBLISHED ENTRIES ARE READ WITHOUT THE MUTEX, THEY NEVER CHANGE OR MOVE
+  size_t last  = lastFont_;
+  size_t count = fontCount_;
+  if (last < count && fontCache_[last].font == font) return fontCache_[last];
+  for (size_t i = 0; i < count; i++) {
+    if (fontCache_[i].font == font) {
+      lastFont_ = i;
+      return fontCache_[i];
+    }
+  }
+
+  // FIRST TIME THIS FONT IS USED, SCAN IT ONCE (ANOTHER TASK MAY HAVE BEATEN US TO IT)
+  if (fontMutex_) xSemaphoreTake(fontMutex_, portMAX_DELAY);
+  for (size_t i = count; i < fontCount_; i++) {
+    if (fontCache_[i].font == font) {
+      if (fontMutex_) xSemaphoreGive(fontMutex_);
+      return fontCache_[i];
+    }
+  }
+  if (fontCount_ == fontCache_.size()) {
+    if (fontMutex_) xSemaphoreGive(fontMutex_);
+    ESP_LOGE(tag, "Font cache full, raise FONT_CACHE_SIZE");
+    return fontCache_[0];
+  }
+
+  FontMetrics& m = fontCache_[fontCount_];
+  m = FontMetrics();
+  m.font = font;
+  if (font) {
+    m.lineHeight = font->yAdvance;
+    int ascent = 0;
+    for (uint16_t c = font->first; c <= font->last; c++) {
+      const GFXglyph& g = font->glyph[c - font->first];
+      if (-g.yOffset > ascent) ascent = -g.yOffset;
+      if (c >= ' ' && c <= '~') m.advance[c - ' '] = g.xAdvance;
+    }
+    m.ascent     = ascent;
+    m.spaceWidth = m.advance[0];
+  } else {
+    memset(m.advance, 6, sizeof(m.advance));
+  }
+  m.avgCharWidth = m.textWidth("abcdefghijklmnopqrstuvwxyz") / 26;
+  m.capHeight    = m.textHeight("H");
+
+  lastFont_ = fontCount_.load();
+  fontCount_++;
+  if (fontMutex_) xSemaphoreGive(fontMutex_);
+  return m;
+}
+uint16_t FontMetrics::advanceWidth(const char* s, size_t n) const {
+  uint16_t w = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint8_t c = (uint8_t)s[i];
+    if (c >= ' ' && c <= '~') w += advance[c - ' '];
+  }
+  return w;
+}
 void PocketmageEink::setTXTFont(const GFXfont* font) {
   // SET THE FONT
   const bool changed = (currentFont_ != font);
@@ -175,6 +464,7 @@ void setupEink() {
   display.init(115200);
   display.setRotation(3);
   display.setFullWindow();
+  display.fillScreen(GxEPD_WHITE);
   display.setTextColor(GxEPD_BLACK);
   EINK().setTXTFont(&FreeMonoBold9pt7b); // default font, computeFontMetrics_()
 
@@ -188,12 +478,12 @@ void setupEink() {
     0                        // Core ID 
   );
 
+  EINK().startFlushTask();
+
 }
 
 uint16_t PocketmageEink::getEinkTextWidth(const String& s) {
-  int16_t x1, y1; uint16_t w, h;
-  display.getTextBounds(s, 0, 0, &x1, &y1, &w, &h);
-  return w;
+  return fontMetrics(display_.getFont()).textWidth(s.c_str(), s.length());
 }
 
 // ===================== getter functions =====================
@@ -8,33 +8,162 @@
 
 #include <pocketmage.h>
 #include <globals.h>
-#include <config.h> // for FULL_REFRESH_AFTER
+#include <config.h>
 #include <SD_MMC.h>
 #include <SD.h>
 #include <SPI.h>
+#include <freertos/timers.h>
+#include <esp_heap_caps.h>
 
 static constexpr const char* TAG = "SD";
 
 extern bool SAVE_POWER;
 
-// Initialization of sd classes
-static PocketmageSDMMC pm_sdmmc;
-static PocketmageSDSPI pm_sdspi;
-static PocketmageSDAUTO pm_sdauto;
+// Initialization of sd class
+static PocketmageSD pm_sd;
+
+// ===================== STORAGE LOCK =====================
+static SemaphoreHandle_t fsLock = NULL;
+
+SDLock::SDLock() {
+  // Created by setupSD() before any other task exists, this only covers use before that
+  if (fsLock == NULL) fsLock = xSemaphoreCreateRecursiveMutex();
+  xSemaphoreTakeRecursive(fsLock, portMAX_DELAY);
+}
+SDLock::~SDLock() {
+  xSemaphoreGiveRecursive(fsLock);
+}
+bool SDLock::heldByMe() {
+  return fsLock != NULL && xSemaphoreGetMutexHolder(fsLock) == xTaskGetCurrentTaskHandle();
+}
+
+// ===================== STORAGE SESSION =====================
+static SemaphoreHandle_t sessionLock  = NULL;
+static TimerHandle_t     sessionTimer = NULL;
+static int               sessionDepth = 0;
+static ulong             sessionStart = 0;
+static SDSession::Stats  sessionStats;
+
+// Runs on the timer task once the grace period passes with no session open
+static void sessionRampDown(TimerHandle_t) {
+  // A session is opening right now, look again after another grace period
+  if (xSemaphoreTake(sessionLock, 0) != pdTRUE) {
+    xTimerReset(sessionTimer, 0);
+    return;
+  }
+
+  if (sessionDepth == 0 && SAVE_POWER) {
+    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+    sessionStats.rampDowns++;
+    ESP_LOGD(TAG, "SD idle: %u sessions, %u ramp-ups, %u ms active (longest %u ms)",
+             sessionStats.sessions, sessionStats.rampUps, sessionStats.activeMs,
+             sessionStats.longestMs);
+  }
+
+  xSemaphoreGive(sessionLock);
+}
+
+SDSession::SDSession() {
+  if (sessionLock == NULL) {
+    sessionLock  = xSemaphoreCreateMutex();
+    sessionTimer = xTimerCreate("sdSession", pdMS_TO_TICKS(SD_SESSION_GRACE_MS), pdFALSE, NULL,
+                                sessionRampDown);
+  }
+
+  xSemaphoreTake(sessionLock, portMAX_DELAY);
+  sessionStats.sessions++;
+
+  if (sessionDepth++ == 0) {
+    xTimerStop(sessionTimer, 0);
+    SDActive = true;
+    sessionStart = millis();
+
+    // Only pay for the ramp if the grace period ran out or something else lowered the clock
+    if (getCpuFrequencyMhz() != 240) {
+      pocketmage::setCpuSpeed(240);
+      delay(50);
+      sessionStats.rampUps++;
+    }
+  }
+
+  xSemaphoreGive(sessionLock);
+}
+
+SDSession::~SDSession() {
+  xSemaphoreTake(sessionLock, portMAX_DELAY);
+
+  if (--sessionDepth == 0) {
+    uint32_t held = millis() - sessionStart;
+    sessionStats.activeMs += held;
+    if (held > sessionStats.longestMs)
+      sessionStats.longestMs = held;
+
+    SDActive = false;
+    xTimerReset(sessionTimer, 0);
+  }
+
+  xSemaphoreGive(sessionLock);
+}
+
+SDSession::Stats SDSession::getStats() { return sessionStats; }
 
 // Helpers
-static int countVisibleChars(String input) {
-  int count = 0;
-
-  for (size_t i = 0; i < input.length(); i++) {
-    char c = input[i];
-    // Check if the character is a visible character or space
-    if (c >= 32 && c <= 126) {  // ASCII range for printable characters and space
-      count++;
+static int countVisibleChars(const String& input) {
+  return (int)PocketmageStore::countVisibleChars(input.c_str(), input.length());
+}
+
+// Mount timing of this boot, see PocketmageSD::getMountStats()
+static PocketmageSD::MountStats mountStats;
+
+// Card identity for the next boot's fast mount. A changed card is only logged, the layout
+// marker decides whether it needs setting up. CARD_NONE: mount failed, next boot goes slow.
+static void rememberCard(uint8_t type, uint64_t size, uint8_t knownType, uint64_t knownSize) {
+  if (type == knownType && size == knownSize) return;   // Nothing to write, keeps NVS wear down
+
+  if (type != CARD_NONE && knownType != CARD_NONE)
+    ESP_LOGI(TAG, "Different card: type %u, %llu MB", type, size / (1024 * 1024));
+
+  prefs.begin("PocketMage", false);
+  prefs.putUChar("SD_CARD_T", type);
+  prefs.putULong64("SD_CARD_SZ", size);
+  prefs.end();
+}
+
+// Directories, guides and system files the OS expects. Once they are in place the marker
+// records SD_LAYOUT_VERSION, later boots read the marker and skip the rest.
+// Returns whether the scaffolding ran.
+static bool ensureLayout(const char* guideBackground, const char* guideCommands) {
+  File marker = global_fs->open(SYS_LAYOUT_MARKER);
+  if (marker) {
+    char version[12] = {};
+    marker.read((uint8_t*)version, sizeof(version) - 1);
+    marker.close();
+    if (atoi(version) == SD_LAYOUT_VERSION) return false;
+  }
+
+  const char* dirs[] = {"/sys", "/notes", "/journal", "/dict", "/apps",
+                        "/apps/temp", "/assets", "/assets/backgrounds"};
+  for (auto dir : dirs) if (!global_fs->exists(dir)) global_fs->mkdir(dir);
+
+  // (Re)write system guides, they are ours and an old layout means their text may be old too
+  File guide = global_fs->open("/assets/backgrounds/HOWTOADDBACKGROUNDS.txt", FILE_WRITE);
+  if (guide) { guide.print(guideBackground); guide.close(); }
+
+  guide = global_fs->open("/sys/COMMAND_MANUAL.txt", FILE_WRITE);
+  if (guide) { guide.print(guideCommands); guide.close(); }
+
+  // Ensure system files exist
+  const char* sysFiles[] = {"/sys/events.txt", "/sys/tasks.txt"};
+  for (auto file : sysFiles) {
+    if (!global_fs->exists(file)) {
+      File f = global_fs->open(file, FILE_WRITE);
+      if (f) f.close();
     }
   }
 
-  return count;
+  File f = global_fs->open(SYS_LAYOUT_MARKER, FILE_WRITE);
+  if (f) { f.print(SD_LAYOUT_VERSION); f.close(); }
+  return true;
 }
 
 // Setup for SD Class
@@ -108,6 +237,8 @@ void setupSD() {
     "- (ENTER) | Create a new line\n" 
     "- (SHFT) + ( < ) | Change text style (body, heading, etc.)\n" 
     "- (SHFT) + ( > ) | Change formatting (bold, italics, etc.)\n" 
+    "- (FN) + (SHFT) + ( o ) | Find, optionally replace all\n" 
+    "- (FN) + (SHFT) + ( < ) AND ( > ) | Previous / next match\n" 
     "- Scroll Bar | Swipe up or down to scroll through the document\n" 
     "\n" 
     "---\n" 
@@ -192,7 +323,7 @@ void setupSD() {
     "- ( S ) | Swap app in selected slot (choose a .tar file)\n" 
     "- ( D ) | Delete app in selected slot\n" 
     "- (FN) + ( < ) | Exit app / return to menu\n" 
-    "- Progress Bar | Shows extraction (0–50%) and installation (50–100%) status\n" 
+    "- Progress Bar | Shows extraction (0–50%), assets (50–60%) and flashing (60–100%) status\n" 
     "\n" 
     "---\n" 
     "## Sleep Modes\n" 
@@ -205,14 +336,26 @@ void setupSD() {
     "- sleep button to enter now-later\n" 
     "- sleep button to wake\n";
 
+  // One owner of global_fs at a time, created before the other tasks start
+  if (fsLock == NULL) fsLock = xSemaphoreCreateRecursiveMutex();
+  PM_IO().begin();
+  // Anything the store writes or removes drops the stale listings
+  PM_STORE().onChanged([](const std::string& path) { PM_DIRS().invalidate(String(path.c_str())); });
+
   // ---------- SDMMC mode ----------
-  // Load compatibility mode
+  // Load compatibility mode, and the card the last boot mounted
   prefs.begin("PocketMage", true);
   SD_SPI_COMPATIBILITY = prefs.getBool("SD_SPI_CMPT", false);
   ALLOW_NO_MICROSD = prefs.getBool("ALLOW_NO_SD", true);
+  uint8_t  knownType = prefs.getUChar("SD_CARD_T", CARD_NONE);
+  uint64_t knownSize = prefs.getULong64("SD_CARD_SZ", 0);
   prefs.end();
   Serial.print("SD_SPI_CMPT" + String(SD_SPI_COMPATIBILITY));
-  delay(100);
+
+  // The last boot mounted a card, skip the settle delays and try once before the slow path
+  bool fast = knownType != CARD_NONE;
+  if (!fast) delay(100);
+  ulong mountStart = millis();
 
   if (!SD_SPI_COMPATIBILITY) {
     // Set global filesystem
@@ -224,7 +367,19 @@ void setupSD() {
     bool sdOK = false;
     bool startedSD = false;
     sdcard_type_t cardType = CARD_NONE;
-    for (int attempt = 1; attempt <= 25; attempt++) {
+    if (fast) {
+      if (SD_MMC.begin("/sdcard", true)) {
+        startedSD = true;
+        cardType = SD_MMC.cardType();
+        sdOK = cardType != CARD_NONE;
+      }
+      if (!sdOK) {
+        ESP_LOGW(TAG, "Fast mount failed, retrying");
+        SD_MMC.end();
+        fast = false;
+      }
+    }
+    for (int attempt = 1; !sdOK && attempt <= 25; attempt++) {
         if (SD_MMC.begin("/sdcard", true)) {
             startedSD = true;
             delay(120); 
@@ -240,6 +395,7 @@ void setupSD() {
 
     if (!sdOK) {
         ESP_LOGE(TAG, "MOUNT FAILED");
+        rememberCard(CARD_NONE, 0, knownType, knownSize);
         if (startedSD) {
             OLED().oledWord(
                 String("SD Not Detected! [") +
@@ -264,7 +420,7 @@ void setupSD() {
         if (ALLOW_NO_MICROSD) {
           OLED().oledWord("All Work Will Be Lost!", false, false);
           delay(5000);
-          PM_SDMMC().setNoSD(true);
+          PM_SDAUTO().setNoSD(true);
           return;
         } else {
           OLED().oledWord("Insert SD Card and Reboot!", false, false);
@@ -276,34 +432,7 @@ void setupSD() {
         }
     }
 
-    prefs.begin("PocketMage", false);
-    prefs.putBool("SD_SPI_CMPT", false);
-    prefs.end();
-
-    // ---------- Filesystem setup ----------
-    const char* dirs[] = {"/sys", "/notes", "/journal", "/dict", "/apps",
-                          "/apps/temp", "/assets", "/assets/backgrounds"};
-    for (auto dir : dirs) if (!global_fs->exists(dir)) global_fs->mkdir(dir);
-
-    // Create system guides
-    if (!global_fs->exists("/assets/backgrounds/HOWTOADDBACKGROUNDS.txt")) {
-      File f = global_fs->open("/assets/backgrounds/HOWTOADDBACKGROUNDS.txt", FILE_WRITE);
-      if (f) { f.print(GUIDE_BACKGROUND); f.close(); }
-    }
-
-    if (!global_fs->exists("/sys/COMMAND_MANUAL.txt")) {
-      File f = global_fs->open("/sys/COMMAND_MANUAL.txt", FILE_WRITE);
-      if (f) { f.print(GUIDE_COMMANDS); f.close(); }
-    }
-
-    // Ensure system files exist
-    const char* sysFiles[] = {"/sys/events.txt", "/sys/tasks.txt", "/sys/SDMMC_META.txt"};
-    for (auto file : sysFiles) {
-      if (!global_fs->exists(file)) {
-        File f = global_fs->open(file, FILE_WRITE);
-        if (f) f.close();
-      }
-    }
+    rememberCard(cardType, SD_MMC.cardSize(), knownType, knownSize);
   }
 
   // ---------- SDSPI mode ----------
@@ -318,13 +447,14 @@ void setupSD() {
       pinMode(hspi->pinSS(), OUTPUT);  //HSPI SS
       if (!SD.begin(SD_CS, *hspi, 40000000)) { // adjust SPI frequency as needed
           ESP_LOGE(TAG, "SPI SD Mount Failed");
+          rememberCard(CARD_NONE, 0, knownType, knownSize);
           OLED().oledWord("SPI SD Not Detected!", false, false);
           delay(2000);
 
           if (ALLOW_NO_MICROSD) {
               OLED().oledWord("All Work Will Be Lost!", false, false);
               delay(5000);
-              PM_SDSPI().setNoSD(true);
+              PM_SDAUTO().setNoSD(true);
               return;
           } else {
               OLED().oledWord("Compatibility Mode Failed. Retrying...", false, false);
@@ -340,736 +470,902 @@ void setupSD() {
       }
       OLED().oledWord("SD Started In Compatibility Mode", false, false);
 
-      // ---------- Filesystem setup ----------
-      const char* dirs[] = {"/sys", "/notes", "/journal", "/dict", "/apps",
-                            "/apps/temp", "/assets", "/assets/backgrounds"};
-      for (auto dir : dirs) if (!global_fs->exists(dir)) global_fs->mkdir(dir);
+      rememberCard(SD.cardType(), SD.cardSize(), knownType, knownSize);
+  }
 
-      // Create system guides
-      if (!global_fs->exists("/assets/backgrounds/HOWTOADDBACKGROUNDS.txt")) {
-          File f = global_fs->open("/assets/backgrounds/HOWTOADDBACKGROUNDS.txt", FILE_WRITE);
-          if (f) { f.print(GUIDE_BACKGROUND); f.close(); }
-      }
+  mountStats.fastPath = fast;
+  mountStats.mountMs  = millis() - mountStart;
 
-      if (!global_fs->exists("/sys/COMMAND_MANUAL.txt")) {
-          File f = global_fs->open("/sys/COMMAND_MANUAL.txt", FILE_WRITE);
-          if (f) { f.print(GUIDE_COMMANDS); f.close(); }
-      }
+  // ---------- Filesystem setup ----------
+  ulong layoutStart = millis();
+  mountStats.layoutChecked = ensureLayout(GUIDE_BACKGROUND, GUIDE_COMMANDS);
+  mountStats.layoutMs = millis() - layoutStart;
 
-      // Ensure system files exist
-      const char* sysFiles[] = {"/sys/events.txt", "/sys/tasks.txt", "/sys/SDMMC_META.txt"};
-      for (auto file : sysFiles) {
-          if (!global_fs->exists(file)) {
-              File f = global_fs->open(file, FILE_WRITE);
-              if (f) f.close();
-          }
-      }
-  }
+  ESP_LOGI(TAG, "SD mounted in %u ms (%s), layout %s in %u ms", mountStats.mountMs,
+           fast ? "fast path" : "full retry", mountStats.layoutChecked ? "built" : "current",
+           mountStats.layoutMs);
 }
 
-// SDAUTO decides automatically between SPI and SDMMC based on which works for a specific card.
-#pragma region SDAUTO
-PocketmageSDAUTO& PM_SDAUTO() { return pm_sdauto; }
+// Metadata for every file the OS writes, shared by both SD backends
+#pragma region META
+static PocketmageMetaStore pm_meta;
+static constexpr char META_MAGIC[8] = "PMMETA1";
+static_assert(sizeof(PocketmageMetaStore::Record) == 128, "metadata records are fixed at 128 bytes");
 
-void PocketmageSDAUTO::saveFile() {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().saveFile();
-  else PM_SDMMC().saveFile();
-}
-void PocketmageSDAUTO::writeMetadata(const String& path) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().writeMetadata(path);
-  else PM_SDMMC().writeMetadata(path);
-}
-void PocketmageSDAUTO::loadFile(bool showOLED) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().loadFile(showOLED);
-  else PM_SDMMC().loadFile(showOLED);
-}
-void PocketmageSDAUTO::delFile(String fileName) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().delFile(fileName);
-  else PM_SDMMC().delFile(fileName);
-}
-void PocketmageSDAUTO::deleteMetadata(String path) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().deleteMetadata(path);
-  else PM_SDMMC().deleteMetadata(path);
-}
-void PocketmageSDAUTO::renFile(String oldFile, String newFile) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().renFile(oldFile, newFile);
-  else PM_SDMMC().renFile(oldFile, newFile);
-}
-void PocketmageSDAUTO::renMetadata(String oldPath, String newPath) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().renMetadata(oldPath, newPath);
-  else PM_SDMMC().renMetadata(oldPath, newPath);
+// Access for other apps
+PocketmageMetaStore& PM_META() { return pm_meta; }
+
+bool PocketmageMetaStore::put(const String& path, const char* timestamp, uint32_t sizeBytes, uint32_t charCount) {
+  if (!load_()) return false;
+  if (path.length() >= sizeof(Record::path)) {
+    ESP_LOGE(TAG, "Path too long for metadata: %s", path.c_str());
+    return false;
+  }
+
+  Record rec = {};
+  strncpy(rec.path, path.c_str(), sizeof(rec.path) - 1);
+  strncpy(rec.timestamp, timestamp, sizeof(rec.timestamp) - 1);
+  rec.sizeBytes = sizeBytes;
+  rec.charCount = charCount;
+
+  File f = global_fs->open(SYS_METADATA_STORE, "r+");
+  if (!f) {
+    ESP_LOGE(TAG, "Failed to open metadata store: %s", SYS_METADATA_STORE);
+    return false;
+  }
+
+  uint32_t hash = hash_(rec.path);
+  int slot = find_(f, rec.path, hash, nullptr);
+  bool isNew = (slot < 0);
+  if (isNew) {
+    if (!freeSlots_.empty()) {
+      slot = freeSlots_.back();
+      freeSlots_.pop_back();
+    } else {
+      slot = slotCount_++;
+    }
+  }
+
+  bool ok = writeSlot_(f, slot, rec);
+  f.close();
+  if (ok && isNew) index_.emplace(hash, slot);
+  return ok;
 }
-void PocketmageSDAUTO::copyFile(String oldFile, String newFile) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().copyFile(oldFile, newFile);
-  else PM_SDMMC().copyFile(oldFile, newFile);
+bool PocketmageMetaStore::get(const String& path, Record& out) {
+  if (!load_()) return false;
+  File f = global_fs->open(SYS_METADATA_STORE, FILE_READ);
+  if (!f) return false;
+  int slot = find_(f, path.c_str(), hash_(path.c_str()), &out);
+  f.close();
+  return slot >= 0;
 }
-void PocketmageSDAUTO::appendToFile(String path, String inText) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().appendToFile(path, inText);
-  else PM_SDMMC().appendToFile(path, inText);
+bool PocketmageMetaStore::remove(const String& path) {
+  if (!load_()) return false;
+  File f = global_fs->open(SYS_METADATA_STORE, "r+");
+  if (!f) return false;
+
+  uint32_t hash = hash_(path.c_str());
+  int slot = find_(f, path.c_str(), hash, nullptr);
+  if (slot >= 0) {
+    Record empty = {};
+    writeSlot_(f, slot, empty);
+    unindex_(hash, slot);
+    freeSlots_.push_back(slot);
+  }
+  f.close();
+  return slot >= 0;
 }
+bool PocketmageMetaStore::rename(const String& oldPath, const String& newPath) {
+  if (!load_()) return false;
+  if (newPath.length() >= sizeof(Record::path)) {
+    ESP_LOGE(TAG, "Path too long for metadata: %s", newPath.c_str());
+    return false;
+  }
+  // an existing entry for the new path is replaced
+  remove(newPath);
 
-// ===================== low level functions =====================
-void PocketmageSDAUTO::listDir(fs::FS &fs, const char *dirname) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().listDir(fs, dirname);
-  else PM_SDMMC().listDir(fs, dirname);
+  File f = global_fs->open(SYS_METADATA_STORE, "r+");
+  if (!f) return false;
+
+  Record rec;
+  uint32_t oldHash = hash_(oldPath.c_str());
+  int slot = find_(f, oldPath.c_str(), oldHash, &rec);
+  if (slot >= 0) {
+    memset(rec.path, 0, sizeof(rec.path));
+    strncpy(rec.path, newPath.c_str(), sizeof(rec.path) - 1);
+    writeSlot_(f, slot, rec);
+    unindex_(oldHash, slot);
+    index_.emplace(hash_(rec.path), slot);
+  }
+  f.close();
+  return slot >= 0;
 }
-void PocketmageSDAUTO::readFile(fs::FS &fs, const char *path) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().readFile(fs, path);
-  else PM_SDMMC().readFile(fs, path);
+size_t PocketmageMetaStore::count() {
+  load_();
+  return index_.size();
 }
-String PocketmageSDAUTO::readFileToString(fs::FS &fs, const char *path) {
-  if (SD_SPI_COMPATIBILITY) return PM_SDSPI().readFileToString(fs, path);
-  return PM_SDMMC().readFileToString(fs, path);
+
+bool PocketmageMetaStore::load_() {
+  if (loaded_) return true;
+  if (!global_fs) return false;
+
+  // READ EVERY RECORD ONCE TO BUILD THE INDEX
+  File f = global_fs->open(SYS_METADATA_STORE, FILE_READ);
+  char magic[8] = {};
+  if (f) f.read((uint8_t*)magic, sizeof(magic));
+
+  if (f && memcmp(magic, META_MAGIC, sizeof(magic)) == 0) {
+    slotCount_ = (f.size() - headerBytes_) / sizeof(Record);
+    f.seek(headerBytes_);
+    Record rec;
+    for (uint16_t slot = 0; slot < slotCount_; slot++) {
+      if (f.read((uint8_t*)&rec, sizeof(rec)) != sizeof(rec)) {
+        slotCount_ = slot;
+        break;
+      }
+      if (rec.path[0]) index_.emplace(hash_(rec.path), slot);
+      else freeSlots_.push_back(slot);
+    }
+    f.close();
+    loaded_ = true;
+    ESP_LOGI(TAG, "Metadata store loaded: %u files, %u free slots", index_.size(), freeSlots_.size());
+    return true;
+  }
+  if (f) {
+    f.close();
+    ESP_LOGE(TAG, "Metadata store unreadable, recreating: %s", SYS_METADATA_STORE);
+  }
+
+  // NEW STORE, HEADER ONLY
+  f = global_fs->open(SYS_METADATA_STORE, FILE_WRITE);
+  if (!f) {
+    ESP_LOGE(TAG, "Failed to create metadata store: %s", SYS_METADATA_STORE);
+    return false;
+  }
+  uint8_t header[headerBytes_] = {};
+  memcpy(header, META_MAGIC, sizeof(META_MAGIC));
+  f.write(header, sizeof(header));
+  f.close();
+
+  loaded_ = true;
+  migrate_();
+  return true;
 }
-void PocketmageSDAUTO::writeFile(fs::FS &fs, const char *path, const char *message) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().writeFile(fs, path, message);
-  else PM_SDMMC().writeFile(fs, path, message);
+void PocketmageMetaStore::migrate_() {
+  // path|YYYYMMDD-HHMM|<n> Bytes|<n> Char
+  File old = global_fs->open(SYS_METADATA_FILE, FILE_READ);
+  if (!old) return;
+
+  int migrated = 0;
+  while (old.available()) {
+    String line = old.readStringUntil('\n');
+    line.trim();
+    int p1 = line.indexOf('|');
+    int p2 = line.indexOf('|', p1 + 1);
+    int p3 = line.indexOf('|', p2 + 1);
+    if (p1 <= 0 || p2 < 0 || p3 < 0) continue;
+
+    String stamp = line.substring(p1 + 1, p2);
+    long size  = line.substring(p2 + 1, p3).toInt();   // toInt() stops at " Bytes"
+    long chars = line.substring(p3 + 1).toInt();
+    if (put(line.substring(0, p1), stamp.c_str(), size, chars)) migrated++;
+  }
+  old.close();
+
+  global_fs->rename(SYS_METADATA_FILE, String(SYS_METADATA_FILE) + ".old");
+  ESP_LOGI(TAG, "Migrated %d metadata entries from %s", migrated, SYS_METADATA_FILE);
 }
-void PocketmageSDAUTO::appendFile(fs::FS &fs, const char *path, const char *message) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().appendFile(fs, path, message);
-  else PM_SDMMC().appendFile(fs, path, message);
+int PocketmageMetaStore::find_(File& f, const char* path, uint32_t hash, Record* out) {
+  Record rec;
+  auto range = index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    // hashes can collide, the record itself has the final say
+    if (readSlot_(f, it->second, rec) && strcmp(rec.path, path) == 0) {
+      if (out) *out = rec;
+      return it->second;
+    }
+  }
+  return -1;
 }
-void PocketmageSDAUTO::renameFile(fs::FS &fs, const char *path1, const char *path2) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().renameFile(fs, path1, path2);
-  else PM_SDMMC().renameFile(fs, path1, path2);
+bool PocketmageMetaStore::readSlot_(File& f, uint16_t slot, Record& r) {
+  if (!f.seek(headerBytes_ + (uint32_t)slot * sizeof(Record))) return false;
+  return f.read((uint8_t*)&r, sizeof(r)) == sizeof(r);
 }
-void PocketmageSDAUTO::deleteFile(fs::FS &fs, const char *path) {
-  if (SD_SPI_COMPATIBILITY) PM_SDSPI().deleteFile(fs, path);
-  else PM_SDMMC().deleteFile(fs, path);
+bool PocketmageMetaStore::writeSlot_(File& f, uint16_t slot, const Record& r) {
+  if (!f.seek(headerBytes_ + (uint32_t)slot * sizeof(Record))) return false;
+  if (f.write((const uint8_t*)&r, sizeof(r)) != sizeof(r)) {
+    ESP_LOGE(TAG, "Metadata write failed at slot %u", slot);
+    return false;
+  }
+  PM_DIRS().invalidate(SYS_METADATA_STORE);
+  return true;
 }
-bool PocketmageSDAUTO::readBinaryFile(const char* path, uint8_t* buf, size_t len) {
-  if (SD_SPI_COMPATIBILITY) return PM_SDSPI().readBinaryFile(path, buf, len);
-  return PM_SDMMC().readBinaryFile(path, buf, len);
+void PocketmageMetaStore::unindex_(uint32_t hash, uint16_t slot) {
+  auto range = index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == slot) {
+      index_.erase(it);
+      return;
+    }
+  }
 }
-size_t PocketmageSDAUTO::getFileSize(const char* path) {
-  if (SD_SPI_COMPATIBILITY) return PM_SDSPI().getFileSize(path);
-  return PM_SDMMC().getFileSize(path);
+uint32_t PocketmageMetaStore::hash_(const char* s) {
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  while (*s) {
+    h ^= (uint8_t)*s++;
+    h *= 16777619u;
+  }
+  return h;
 }
 #pragma endregion
 
 
-// SDMMC is Espressif's built-in hardware for SD cards on ESP32
-#pragma region SDMMC
-// Access for other apps
-PocketmageSDMMC& PM_SDMMC() { return pm_sdmmc; }
-    
-void PocketmageSDMMC::saveFile() {
-  if (PM_SDMMC().getNoSD()) {
-      OLED().oledWord("SAVE FAILED - No SD!");
-      delay(5000);
-      return;
-  } else {
-      SDActive = true;
-      pocketmage::setCpuSpeed(240);
-      delay(50);
+// global_fs behind PocketmageFs, the storage service runs on top of it
+#pragma region STORE
+namespace {
+class ArduinoFsFile : public PocketmageFsFile {
+public:
+  explicit ArduinoFsFile(File f) : f_(f) {}
+  ~ArduinoFsFile() override { f_.close(); }
+
+  size_t read(uint8_t* buf, size_t len) override { return f_.read(buf, len); }
+  size_t write(const uint8_t* buf, size_t len) override { return f_.write(buf, len); }
+  bool   seek(uint32_t pos) override { return f_.seek(pos); }
+  size_t position() override { return f_.position(); }
+  size_t size() override { return f_.size(); }
+  bool   isDirectory() override { return f_.isDirectory(); }
+
+private:
+  File f_;
+};
+
+// Looks global_fs up on every call, setupSD() can point it at SD_MMC or SD
+class ArduinoFs : public PocketmageFs {
+public:
+  std::unique_ptr<PocketmageFsFile> open(const char* path, const char* mode) override {
+    if (!global_fs) return nullptr;
+    File f = global_fs->open(path, mode);
+    if (!f) return nullptr;
+    return std::unique_ptr<PocketmageFsFile>(new ArduinoFsFile(f));
+  }
+  bool exists(const char* path) override { return global_fs && global_fs->exists(path); }
+  bool mkdir(const char* path) override { return global_fs && global_fs->mkdir(path); }
+  bool rmdir(const char* path) override { return global_fs && global_fs->rmdir(path); }
+  bool remove(const char* path) override { return global_fs && global_fs->remove(path); }
+  bool rename(const char* from, const char* to) override {
+    return global_fs && global_fs->rename(from, to);
+  }
+  bool list(const char* dir, std::vector<Entry>& out) override {
+    out.clear();
+    if (!global_fs) return false;
+    File root = global_fs->open(dir);
+    if (!root || !root.isDirectory()) {
+      if (root) root.close();
+      return false;
+    }
 
-      String textToSave = vectorToString();
-      ESP_LOGV(TAG, "Text to save: %s", textToSave.c_str());
-
-      if (PM_SDMMC().getEditingFile() == "" || PM_SDMMC().getEditingFile() == "-")
-      PM_SDMMC().setEditingFile("/temp.txt");
-      keypad.disableInterrupts();
-      if (!PM_SDMMC().getEditingFile().startsWith("/"))
-      PM_SDMMC().setEditingFile("/" + PM_SDMMC().getEditingFile());
-      //OLED().oledWord("Saving File: "+ editingFile);
-      PM_SDMMC().writeFile(SD_MMC, (PM_SDMMC().getEditingFile()).c_str(), textToSave.c_str());
-      //OLED().oledWord("Saved: "+ editingFile);
-
-      // Write MetaData
-      PM_SDMMC().writeMetadata(PM_SDMMC().getEditingFile());
-
-      // delay(1000);
-      keypad.enableInterrupts();
-      if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-      SDActive = false;
-  }
-}  
-void PocketmageSDMMC::writeMetadata(const String& path) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  File file = global_fs->open(path);
-  if (!file || file.isDirectory()) {
-      OLED().oledWord("META WRITE ERR");
-      delay(1000);
-      ESP_LOGE(TAG, "Invalid file for metadata: %s", path);
-      return;
+    File file;
+    while ((file = root.openNextFile())) {
+      // Older cores return the full path from name()
+      const char* full  = file.name();
+      const char* slash = strrchr(full, '/');
+      Entry e;
+      e.name  = slash ? slash + 1 : full;
+      e.isDir = file.isDirectory();
+      e.size  = e.isDir ? 0 : file.size();
+      e.mtime = file.getLastWrite();
+      out.push_back(e);
+      file.close();
+    }
+    root.close();
+    return true;
   }
-  // Get file size
-  size_t fileSizeBytes = file.size();
-  file.close();
+};
+}  // namespace
 
-  // Format size string
-  String fileSizeStr = String(fileSizeBytes) + " Bytes";
+static ArduinoFs       pm_fs;
+static PocketmageStore pm_store(pm_fs);
 
-  // Get line and char counts
-  int charCount = countVisibleChars(PM_SDMMC().readFileToString(SD_MMC, path.c_str()));
+// Access for other apps
+PocketmageFs& PM_FS() { return pm_fs; }
+PocketmageStore& PM_STORE() { return pm_store; }
+#pragma endregion
 
-  String charStr = String(charCount) + " Char";
-  // Get current time from RTC
-  DateTime now = CLOCK().nowDT();
-  char timestamp[20];
-  sprintf(timestamp, "%04d%02d%02d-%02d%02d", now.year(), now.month(), now.day(), now.hour(),
-          now.minute());
 
-  // Compose new metadata line
-  String newEntry = path + "|" + timestamp + "|" + fileSizeStr + "|" + charStr;
-
-  const char* metaPath = SYS_METADATA_FILE;
-  // Read existing entries and rebuild the file without duplicates
-  File metaFile = global_fs->open(metaPath, FILE_READ);
-  String updatedMeta = "";
-  bool replaced = false;
-
-  if (metaFile) {
-      while (metaFile.available()) {
-      String line = metaFile.readStringUntil('\n');
-      if (line.startsWith(path + "|")) {
-          updatedMeta += newEntry + "\n";
-          replaced = true;
-      } else if (line.length() > 1) {
-          updatedMeta += line + "\n";
-      }
-      }
-      metaFile.close();
-  }
+// Recently listed directories, kept until the SD layer changes them
+#pragma region DIRS
+static PocketmageDirCache pm_dirs;
 
-  if (!replaced) {
-      updatedMeta += newEntry + "\n";
-  }
-  // Write back the updated metadata
-  metaFile = global_fs->open(metaPath, FILE_WRITE);
-  if (!metaFile) {
-      ESP_LOGE(TAG, "Failed to open metadata file for writing: %s", metaPath);
-      return;
+// Access for other apps
+PocketmageDirCache& PM_DIRS() { return pm_dirs; }
+
+PocketmageDirCache::ListingPtr PocketmageDirCache::list(const String& dir) {
+  static const ListingPtr empty = std::make_shared<const Listing>();
+  SDLock lock;
+  String key = normalize_(dir);
+
+  for (auto it = lru_.begin(); it != lru_.end(); ++it) {
+    if (it->dir == key) {
+      // Move to the front
+      if (it != lru_.begin()) lru_.splice(lru_.begin(), lru_, it);
+      hits_++;
+      return lru_.front().entries;
+    }
   }
-  metaFile.print(updatedMeta);
-  metaFile.close();
-  ESP_LOGI(TAG, "Metadata updated");
-
-  if (SAVE_POWER)
-  pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
-}  
-void PocketmageSDMMC::loadFile(bool showOLED) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  if (PM_SDMMC().getNoSD()) {
-      OLED().oledWord("LOAD FAILED - No SD!");
-      delay(5000);
-      return;
-  } else {
-      SDActive = true;
-      pocketmage::setCpuSpeed(240);
-      delay(50);
 
-      keypad.disableInterrupts();
-      if (showOLED)
-      OLED().oledWord("Loading File");
-      if (!PM_SDMMC().getEditingFile().startsWith("/"))
-      PM_SDMMC().setEditingFile("/" + PM_SDMMC().getEditingFile());
-      String textToLoad = PM_SDMMC().readFileToString(SD_MMC, (PM_SDMMC().getEditingFile()).c_str());
-      ESP_LOGV(TAG, "Text to load: %s", textToLoad.c_str());
-
-      stringToVector(textToLoad);
-      keypad.enableInterrupts();
-      if (showOLED) {
-      OLED().oledWord("File Loaded");
-      delay(200);
-      }
-      if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-      SDActive = false;
-  }
-}  
-void PocketmageSDMMC::delFile(String fileName) {
-  if (PM_SDMMC().getNoSD()) {
-      OLED().oledWord("DELETE FAILED - No SD!");
-      delay(5000);
-      return;
-  } else {
-      SDActive = true;
-      pocketmage::setCpuSpeed(240);
-      delay(50);
+  misses_++;
+  if (!global_fs) return empty;
 
-      keypad.disableInterrupts();
-      // OLED().oledWord("Deleting File: "+ fileName);
-      if (!fileName.startsWith("/"))
-      fileName = "/" + fileName;
-      PM_SDMMC().deleteFile(SD_MMC, fileName.c_str());
-      // OLED().oledWord("Deleted: "+ fileName);
+  SDSession session;
+  std::vector<PocketmageFs::Entry> listed;
+  if (!PM_FS().list(key.c_str(), listed)) return empty;   // not cached, it may be created later
 
-      // Delete MetaData
-      PM_SDMMC().deleteMetadata(fileName);
+  std::shared_ptr<Listing> entries = std::make_shared<Listing>();
+  entries->reserve(listed.size());
+  for (const PocketmageFs::Entry& l : listed)
+    entries->push_back({String(l.name.c_str()), l.isDir, l.size, l.mtime});
 
-      delay(1000);
-      keypad.enableInterrupts();
-      if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-      SDActive = false;
-  }
-}  
-void PocketmageSDMMC::deleteMetadata(String path) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  const char* metaPath = SYS_METADATA_FILE;
-
-  // Open metadata file for reading
-  File metaFile = global_fs->open(metaPath, FILE_READ);
-  if (!metaFile) {
-      ESP_LOGE(TAG, "Metadata file not found: %s", metaPath);
-      return;
-  }
+  if (lru_.size() >= DIR_CACHE_SIZE) lru_.pop_back();
+  lru_.push_front({key, entries});
 
-  // Store lines that don't match the given path
-  std::vector<String> keptLines;
-  while (metaFile.available()) {
-      String line = metaFile.readStringUntil('\n');
-      if (!line.startsWith(path + "|")) {
-      keptLines.push_back(line);
-      }
-  }
-  metaFile.close();
+  ESP_LOGD(TAG, "Listed %s: %u entries (cache %u hits / %u misses)", key.c_str(),
+           entries->size(), hits_, misses_);
+  return lru_.front().entries;
+}
+void PocketmageDirCache::invalidate(const String& path) {
+  SDLock lock;
+  String key    = normalize_(path);
+  int    slash  = key.lastIndexOf('/');
+  String parent = slash > 0 ? key.substring(0, slash) : "/";
+
+  // The parent's listing is stale, and so is everything under path if it was a directory
+  for (auto it = lru_.begin(); it != lru_.end();) {
+    if (it->dir == parent || it->dir == key || it->dir.startsWith(key + "/"))
+      it = lru_.erase(it);
+    else
+      ++it;
+  }
+  generation_++;
+}
+void PocketmageDirCache::clear() {
+  SDLock lock;
+  lru_.clear();
+  generation_++;
+}
+String PocketmageDirCache::normalize_(String path) {
+  if (!path.startsWith("/")) path = "/" + path;
+  while (path.length() > 1 && path.endsWith("/")) path.remove(path.length() - 1);
+  return path;
+}
+#pragma endregion
 
-  // Delete the original metadata file
-  global_fs->remove(metaPath);
 
-  // Recreate the file and write back the kept lines
-  File writeFile = global_fs->open(metaPath, FILE_WRITE);
-  if (!writeFile) {
-      ESP_LOGE(TAG, "Failed to recreate metadata file. %s", writeFile.path());
-      return;
-  }
+// Buffered file handle. The buffer is one window of the file starting at bufStart_: while
+// READING it holds bytes read ahead of the cursor, while WRITING it holds bytes not yet on the card.
+#pragma region FILE
+PocketmageFile::PocketmageFile(size_t bufferBytes) {
+  cap_ = bufferBytes ? bufferBytes : SD_BUFFER_BYTES;
+  cap_ = (cap_ + 511) & ~(size_t)511;   // Whole sectors
+  setTimeout(0);                         // Nothing to wait for at EOF
+}
+PocketmageFile::~PocketmageFile() {
+  close();
+}
+
+bool PocketmageFile::open(const char* path, const char* mode) {
+  close();
+  if (!global_fs) return false;
 
-  for (const String& line : keptLines) {
-      writeFile.println(line);
+  file_ = global_fs->open(path, mode);
+  if (!file_) return false;
+
+  if (!file_.isDirectory()) {
+    buf_ = (uint8_t*)malloc(cap_);
+    if (!buf_) {
+      ESP_LOGE(TAG, "No memory for a %u byte file buffer", cap_);
+      file_.close();
+      return false;
+    }
   }
 
-  writeFile.close();
-  ESP_LOGI(TAG, "Metadata entry deleted (if it existed).");
-}  
-void PocketmageSDMMC::renFile(String oldFile, String newFile) {
-  if (PM_SDMMC().getNoSD()) {
-      OLED().oledWord("RENAME FAILED - No SD!");
-      delay(5000);
-      return;
-  } else {
-      SDActive = true;
-      pocketmage::setCpuSpeed(240);
-      delay(50);
+  // Append mode writes at the end whatever the cursor says
+  bufStart_ = (mode && mode[0] == 'a') ? file_.size() : file_.position();
+  bufLen_ = bufPos_ = 0;
+  mode_ = IDLE;
+  clearWriteError();
+  return true;
+}
+void PocketmageFile::close() {
+  if (file_) {
+    if (!flushBuffer_()) ESP_LOGE(TAG, "Lost buffered writes to %s", file_.path());
+    file_.close();
+  }
+  free(buf_);
+  buf_ = nullptr;
+  bufLen_ = bufPos_ = 0;
+  mode_ = IDLE;
+}
 
-      keypad.disableInterrupts();
-      // OLED().oledWord("Renaming "+ oldFile + " to " + newFile);
-      if (!oldFile.startsWith("/"))
-      oldFile = "/" + oldFile;
-      if (!newFile.startsWith("/"))
-      newFile = "/" + newFile;
-      PM_SDMMC().renameFile(SD_MMC, oldFile.c_str(), newFile.c_str());
-      OLED().oledWord(oldFile + " -> " + newFile);
-      delay(1000);
+size_t PocketmageFile::position() const {
+  return bufStart_ + (mode_ == WRITING ? bufLen_ : bufPos_);
+}
+size_t PocketmageFile::size() const {
+  size_t onCard = file_ ? file_.size() : 0;
+  size_t end = (mode_ == WRITING) ? bufStart_ + bufLen_ : 0;
+  return max(onCard, end);
+}
 
-      // Update MetaData
-      PM_SDMMC().renMetadata(oldFile, newFile);
-
-      keypad.enableInterrupts();
-      if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-      SDActive = false;
-  }
-}  
-void PocketmageSDMMC::renMetadata(String oldPath, String newPath) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-  const char* metaPath = SYS_METADATA_FILE;
-
-  // Open metadata file for reading
-  File metaFile = global_fs->open(metaPath, FILE_READ);
-  if (!metaFile) {
-      ESP_LOGE(TAG, "Metadata file not found: %s", metaPath);
-      return;
+// Read the buffer-aligned window holding position()
+bool PocketmageFile::fill_() {
+  if (!flushBuffer_()) return false;
+
+  uint32_t pos = position();
+  uint32_t start = pos - (pos % cap_);
+  if (!file_.seek(start)) return false;
+
+  bufStart_ = start;
+  bufLen_ = file_.read(buf_, cap_);
+  bufPos_ = pos - start;
+  mode_ = READING;
+  return bufPos_ < bufLen_;
+}
+
+int PocketmageFile::available() {
+  if (!file_) return 0;
+  size_t pos = position(), end = size();
+  return pos < end ? (int)(end - pos) : 0;
+}
+int PocketmageFile::read() {
+  if (!buf_) return -1;
+  if (mode_ != READING || bufPos_ >= bufLen_) {
+    if (!fill_()) return -1;
+  }
+  return buf_[bufPos_++];
+}
+int PocketmageFile::peek() {
+  if (!buf_) return -1;
+  if (mode_ != READING || bufPos_ >= bufLen_) {
+    if (!fill_()) return -1;
   }
+  return buf_[bufPos_];
+}
+size_t PocketmageFile::read(uint8_t* buf, size_t len) {
+  if (!buf_) return 0;
+  size_t done = 0;
+
+  while (done < len) {
+    if (mode_ == READING && bufPos_ < bufLen_) {
+      size_t n = min(len - done, bufLen_ - bufPos_);
+      memcpy(buf + done, buf_ + bufPos_, n);
+      bufPos_ += n;
+      done += n;
+      continue;
+    }
 
-  std::vector<String> updatedLines;
-
-  while (metaFile.available()) {
-      String line = metaFile.readStringUntil('\n');
-      if (line.startsWith(oldPath + "|")) {
-      // Replace old path with new path at the start of the line
-      int separatorIndex = line.indexOf('|');
-      if (separatorIndex != -1) {
-          // Keep rest of line after '|'
-          String rest = line.substring(separatorIndex);
-          line = newPath + rest;
-      } else {
-          // Just replace whole line with new path if malformed
-          line = newPath;
-      }
-      }
-      updatedLines.push_back(line);
+    // Whole buffers from an aligned position go straight into the caller's memory
+    uint32_t pos = position();
+    size_t left = len - done;
+    if (left >= cap_ && pos % cap_ == 0) {
+      if (!flushBuffer_() || !file_.seek(pos)) break;
+      size_t direct = left - (left % cap_);
+      size_t got = file_.read(buf + done, direct);
+      done += got;
+      bufStart_ = pos + got;
+      bufLen_ = bufPos_ = 0;
+      mode_ = IDLE;
+      if (got < direct) break;
+      continue;
+    }
+
+    if (!fill_()) break;
   }
+  return done;
+}
+
+void PocketmageFile::toWriting_() {
+  if (mode_ == WRITING) return;
+  bufStart_ = position();
+  bufLen_ = bufPos_ = 0;
+  file_.seek(bufStart_);
+  mode_ = WRITING;
+}
+size_t PocketmageFile::write(uint8_t c) {
+  return write(&c, 1);
+}
+size_t PocketmageFile::write(const uint8_t* buf, size_t len) {
+  if (!buf_ || len == 0) return 0;
+  toWriting_();
+  size_t done = 0;
+
+  while (done < len) {
+    // Whole buffers from an aligned position skip the copy
+    size_t left = len - done;
+    if (bufLen_ == 0 && bufStart_ % cap_ == 0 && left >= cap_) {
+      size_t direct = left - (left % cap_);
+      size_t put = file_.write(buf + done, direct);
+      bufStart_ += put;
+      done += put;
+      if (put < direct) { setWriteError(); break; }
+      continue;
+    }
 
-  metaFile.close();
+    // Coalesce up to the next buffer boundary, then write the window out
+    size_t room = cap_ - (bufStart_ % cap_) - bufLen_;
+    size_t n = min(left, room);
+    memcpy(buf_ + bufLen_, buf + done, n);
+    bufLen_ += n;
+    done += n;
+    if (n == room && !flushBuffer_()) break;
+  }
+  return done;
+}
+bool PocketmageFile::flushBuffer_() {
+  if (mode_ != WRITING || bufLen_ == 0) return true;
+
+  size_t put = file_.write(buf_, bufLen_);
+  bufStart_ += put;
+  bool ok = put == bufLen_;
+  if (!ok) {
+    memmove(buf_, buf_ + put, bufLen_ - put);
+    setWriteError();
+  }
+  bufLen_ -= put;
+  return ok;
+}
+void PocketmageFile::flush() {
+  if (!file_) return;
+  flushBuffer_();
+  file_.flush();
+}
 
-  // Delete old metadata file
-  global_fs->remove(metaPath);
+bool PocketmageFile::seek(uint32_t pos) {
+  if (!file_) return false;
 
-  // Recreate file and write updated lines
-  File writeFile = global_fs->open(metaPath, FILE_WRITE);
-  if (!writeFile) {
-      ESP_LOGE(TAG, "Failed to recreate metadata file. %s", writeFile.path());
-      return;
+  if (mode_ == WRITING) {
+    if (!flushBuffer_()) return false;
+    if (!file_.seek(pos)) return false;
+    bufStart_ = pos;
+    return true;
   }
 
-  for (const String& l : updatedLines) {
-      writeFile.println(l);
+  // Inside the read-ahead window, just move the cursor
+  if (mode_ == READING && pos >= bufStart_ && pos < bufStart_ + bufLen_) {
+    bufPos_ = pos - bufStart_;
+    return true;
   }
 
-  writeFile.close();
-  ESP_LOGI(TAG, "Metadata updated for renamed file.");
+  if (pos > file_.size()) return false;
+  bufStart_ = pos;
+  bufLen_ = bufPos_ = 0;
+  mode_ = IDLE;
+  return true;
+}
+#pragma endregion
 
-  if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-} 
-void PocketmageSDMMC::copyFile(String oldFile, String newFile) {
-  if (PM_SDMMC().getNoSD()) {
-      OLED().oledWord("COPY FAILED - No SD!");
-      delay(5000);
-      return;
-  } else {
-      SDActive = true;
-      pocketmage::setCpuSpeed(240);
-      delay(50);
 
-      keypad.disableInterrupts();
-      OLED().oledWord("Loading File");
-      if (!oldFile.startsWith("/"))
-      oldFile = "/" + oldFile;
-      if (!newFile.startsWith("/"))
-      newFile = "/" + newFile;
-      String textToLoad = PM_SDMMC().readFileToString(SD_MMC, (oldFile).c_str());
-      PM_SDMMC().writeFile(SD_MMC, (newFile).c_str(), textToLoad.c_str());
-      OLED().oledWord("Saved: " + newFile);
+// Background storage task, serves PM_IO() requests one at a time under an SDSession
+#pragma region IO
+static PocketmageIO pm_io;
 
-      // Write MetaData
-      PM_SDMMC().writeMetadata(newFile);
+// Access for other apps
+PocketmageIO& PM_IO() { return pm_io; }
 
-      delay(1000);
-      keypad.enableInterrupts();
+void PocketmageIO::taskEntry_(void* parameter) {
+  PocketmageIO& io = *(PocketmageIO*)parameter;
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-      if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-      SDActive = false;
+    Ticket job;
+    while ((job = io.next_())) {
+      io.run_(*job);
+      io.finish_(*job);
+    }
   }
-} 
-void PocketmageSDMMC::appendToFile(String path, String inText) {
-  if (PM_SDMMC().getNoSD()) {
-      OLED().oledWord("OP FAILED - No SD!");
-      delay(5000);
-      return;
-  } else {
-      SDActive = true;
-      pocketmage::setCpuSpeed(240);
-      delay(50);
-
-      keypad.disableInterrupts();
-      PM_SDMMC().appendFile(SD_MMC, path.c_str(), inText.c_str());
-
-      // Write MetaData
-      PM_SDMMC().writeMetadata(path);
+}
 
-      keypad.enableInterrupts();
+void PocketmageIO::begin() {
+  if (lock_ == NULL) lock_ = xSemaphoreCreateMutex();
+}
 
-      if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-      SDActive = false;
+PocketmageIO::Ticket PocketmageIO::submit_(Ticket job) {
+  begin();
+
+  Ticket dropped;
+  xSemaphoreTake(lock_, portMAX_DELAY);
+  // Started by the first request, apps that never use it don't pay for the stack
+  if (task_ == NULL) {
+    xTaskCreatePinnedToCore(
+      taskEntry_,              // Function name
+      "sdIoTask",              // Task name
+      6144,                    // Stack size
+      this,                    // Parameters
+      1,                       // Priority
+      &task_,                  // Task handle
+      0                        // Core ID
+    );
+  }
+
+  std::deque<Ticket>& q = queues_[job->priority];
+  q.push_back(job);
+  // Prefetches are guesses, keep the newest ones
+  if (job->priority == PREFETCH && q.size() > SD_IO_PREFETCH_DEPTH) {
+    dropped = q.front();
+    q.pop_front();
+  }
+  xSemaphoreGive(lock_);
+
+  if (dropped) finish_(*dropped);
+  xTaskNotifyGive(task_);
+  return job;
+}
+PocketmageIO::Ticket PocketmageIO::next_() {
+  Ticket job;
+  xSemaphoreTake(lock_, portMAX_DELAY);
+  for (std::deque<Ticket>& q : queues_) {
+    if (q.empty()) continue;
+    job = q.front();
+    q.pop_front();
+    job->started = true;
+    break;
+  }
+  xSemaphoreGive(lock_);
+  return job;
+}
+bool PocketmageIO::unqueue_(const Ticket& t) {
+  std::deque<Ticket>& q = queues_[t->priority];
+  for (auto it = q.begin(); it != q.end(); ++it) {
+    if (*it == t) {
+      q.erase(it);
+      return true;
+    }
   }
+  return false;
 }
 
-// ===================== low level functions =====================
-// Low-Level SDMMC Operations switch to using internal fs::FS*
-void PocketmageSDMMC::listDir(fs::FS &fs, const char *dirname) {
-  if (noSD_) {
-    OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return;
-  }
-  else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-    noTimeout = true;
-    ESP_LOGI(tag, "Listing directory %s\r\n", dirname);
+void PocketmageIO::run_(Job& job) {
+  Result& r = job.result;
+  if (PM_SDAUTO().getNoSD() || !global_fs) return;
+
+  SDSession session;
+  switch (r.op) {
+    case READ: {
+      PocketmageFile file;
+      if (!file.open(r.path) || file.isDirectory()) break;
+
+      size_t size = file.size();
+      if (job.offset > size || !file.seek(job.offset)) break;
+      size_t want = size - job.offset;
+      if (job.length && job.length < want) want = job.length;
+      if (!r.data.reserve(want)) {
+        ESP_LOGE(TAG, "No memory to read %u bytes of %s", want, r.path.c_str());
+        break;
+      }
 
-    File root = fs.open(dirname);
-    if (!root) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open directory: %s", root.path());
-      return;
+      uint8_t buf[512];
+      while (r.size < want) {
+        size_t n = file.read(buf, min(sizeof(buf), want - r.size));
+        if (n == 0) break;
+        r.data.concat((const char*)buf, n);
+        r.size += n;
+      }
+      r.ok = r.size == want;
+      break;
     }
-    if (!root.isDirectory()) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Not a directory: %s", root.path());
-      
-      return;
+    case WRITE:
+    case APPEND: {
+      const char* data = job.payload.c_str();
+      size_t      len  = job.payload.length();
+      r.ok   = r.op == WRITE ? PM_STORE().writeFile(r.path.c_str(), data, len)
+                             : PM_STORE().appendFile(r.path.c_str(), data, len);
+      r.size = r.ok ? len : 0;
+      job.payload = String();   // Done with it, give the memory back now
+      break;
     }
-
-    // Reset fileIndex and initialize filesList with "-"
-    fileIndex_ = 0; // Reset fileIndex
-    for (int i = 0; i < MAX_FILES; i++) {
-      filesList_[i] = "-";
+    case LIST:
+      r.entries = PM_DIRS().list(r.path);
+      r.ok = !r.entries->empty() || PM_FS().exists(r.path.c_str());
+      break;
+    case STAT: {
+      File file = global_fs->open(r.path);
+      if (!file) break;
+      r.isDir = file.isDirectory();
+      r.size  = r.isDir ? 0 : file.size();
+      r.mtime = file.getLastWrite();
+      file.close();
+      r.ok = true;
+      break;
     }
+  }
+  if (!r.ok) ESP_LOGW(TAG, "Background op %u failed on %s", r.op, r.path.c_str());
+}
+void PocketmageIO::finish_(Job& job) {
+  if (job.onDone) job.onDone(job.result);
+  job.onDone = nullptr;
+  job.done = true;
+}
 
-    File file = root.openNextFile();
-    while (file && fileIndex_ < MAX_FILES) {
-      if (!file.isDirectory()) {
-        String fileName = String(file.name());
-        
-        // Check if file is in the exclusion list
-        bool excluded = false;
-        for (const String &excludedFile : excludedFiles_) {
-          if (fileName.equals(excludedFile) || ("/"+fileName).equals(excludedFile)) {
-            excluded = true;
-            break;
-          }
-        }
-
-        if (!excluded) {
-          filesList_[fileIndex_++] = fileName; // Store file name if not excluded
+PocketmageIO::Ticket PocketmageIO::read(const String& path, size_t offset, size_t length,
+                                        Priority p, Callback onDone) {
+  // The same range may already be queued as a prefetch, share it instead of reading it twice
+  if (lock_ != NULL && !onDone) {
+    Ticket queued;
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (std::deque<Ticket>& q : queues_) {
+      for (const Ticket& t : q) {
+        if (t->result.op == READ && t->result.path == path && t->offset == offset && t->length == length) {
+          queued = t;
+          break;
         }
       }
-      file = root.openNextFile();
+      if (queued) break;
     }
+    if (queued && p < queued->priority && unqueue_(queued)) {
+      queued->priority = p;
+      queues_[p].push_back(queued);
+    }
+    xSemaphoreGive(lock_);
+    if (queued) return queued;
+  }
+
+  Ticket job = std::make_shared<Job>();
+  job->result.op   = READ;
+  job->result.path = path;
+  job->priority    = p;
+  job->offset      = offset;
+  job->length      = length;
+  job->onDone      = onDone;
+  return submit_(job);
+}
+PocketmageIO::Ticket PocketmageIO::write(const String& path, const String& data, Priority p,
+                                         Callback onDone) {
+  Ticket job = std::make_shared<Job>();
+  job->result.op   = WRITE;
+  job->result.path = path;
+  job->priority    = p;
+  job->payload     = data;
+  job->onDone      = onDone;
+  return submit_(job);
+}
+PocketmageIO::Ticket PocketmageIO::append(const String& path, const String& data, Priority p,
+                                          Callback onDone) {
+  Ticket job = std::make_shared<Job>();
+  job->result.op   = APPEND;
+  job->result.path = path;
+  job->priority    = p;
+  job->payload     = data;
+  job->onDone      = onDone;
+  return submit_(job);
+}
+PocketmageIO::Ticket PocketmageIO::list(const String& dir, Priority p, Callback onDone) {
+  Ticket job = std::make_shared<Job>();
+  job->result.op   = LIST;
+  job->result.path = dir;
+  job->priority    = p;
+  job->onDone      = onDone;
+  return submit_(job);
+}
+PocketmageIO::Ticket PocketmageIO::stat(const String& path, Priority p, Callback onDone) {
+  Ticket job = std::make_shared<Job>();
+  job->result.op   = STAT;
+  job->result.path = path;
+  job->priority    = p;
+  job->onDone      = onDone;
+  return submit_(job);
+}
 
-    // for (int i = 0; i < fileIndex_; i++) { // Only print valid entries
-    //   Serial.println(filesList_[i]);       // NOTE: This prints out valid files
-    // }
+bool PocketmageIO::wait(const Ticket& t, uint32_t timeoutMs) {
+  if (!t) return false;
+  if (t->done) return true;
 
-    noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+  // Waiting here would deadlock, the storage task can't run the request until the lock is free
+  if (xTaskGetCurrentTaskHandle() == task_ || SDLock::heldByMe()) {
+    ESP_LOGE(TAG, "wait() on %s while holding the card", t->result.path.c_str());
+    return false;
+  }
+
+  // Someone needs it now, jump the queue
+  xSemaphoreTake(lock_, portMAX_DELAY);
+  if (!t->started && t->priority != URGENT && unqueue_(t)) {
+    t->priority = URGENT;
+    queues_[URGENT].push_front(t);
+  }
+  xSemaphoreGive(lock_);
+
+  ulong start = millis();
+  while (!t->done) {
+    if (timeoutMs != UINT32_MAX && millis() - start >= timeoutMs) return false;
+    vTaskDelay(1);
   }
+  return true;
 }
-void PocketmageSDMMC::readFile(fs::FS &fs, const char *path) {
-  if (noSD_) {
-    OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return;
-  }
-  else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-    noTimeout = true;
-    ESP_LOGI(tag, "Reading file %s\r\n", path);
+void PocketmageIO::cancel(const Ticket& t) {
+  if (!t || lock_ == NULL) return;
 
-    File file = fs.open(path);
-    if (!file || file.isDirectory()) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open file for reading: %s", file.path());
-      return;
-    }
+  xSemaphoreTake(lock_, portMAX_DELAY);
+  bool removed = !t->started && unqueue_(t);
+  xSemaphoreGive(lock_);
 
-    file.close();
-    noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  }
+  if (removed) finish_(*t);
 }
-String PocketmageSDMMC::readFileToString(fs::FS &fs, const char *path) {
-  if (noSD_) {
-    OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return "";
-  }
-  else { 
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-
-    noTimeout = true;
-    ESP_LOGI(tag, "Reading file: %s\r\n", path);
-
-    File file = fs.open(path);
-    if (!file || file.isDirectory()) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open file for reading: %s", path);
-      OLED().oledWord("Load Failed");
-      delay(500);
-      return "";  // Return an empty string on failure
-    }
-
-    ESP_LOGI(tag, "Reading from file: %s", file.path());
-    String content = file.readString();
-
-    file.close();
-    EINK().setFullRefreshAfter(FULL_REFRESH_AFTER); //Force a full refresh
-    noTimeout = false;
-    return content;  // Return the complete String
-  }
+size_t PocketmageIO::pending() {
+  if (lock_ == NULL) return 0;
+
+  size_t n = 0;
+  xSemaphoreTake(lock_, portMAX_DELAY);
+  for (const std::deque<Ticket>& q : queues_) n += q.size();
+  xSemaphoreGive(lock_);
+  return n;
 }
-void PocketmageSDMMC::writeFile(fs::FS &fs, const char *path, const char *message) {
-  if (noSD_) {
-    OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return;
-  }
-  else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-    noTimeout = true;
-    ESP_LOGI(tag, "Writing file: %s\r\n", path);
-    delay(200);
+#pragma endregion
 
-    File file = fs.open(path, FILE_WRITE);
-    if (!file) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open %s for writing", path);
-      return;
-    }
-    if (file.print(message)) {
-      ESP_LOGV(tag, "File written %s", path);
-    } 
-    else {
-      ESP_LOGE(tag, "Write failed for %s", path);
-    }
-    file.close();
-    noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  }
-}
-void PocketmageSDMMC::appendFile(fs::FS &fs, const char *path, const char *message) {
-  if (noSD_) {
-    OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return;
-  }
-  else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-    noTimeout = true;
-    ESP_LOGI(tag, "Appending to file: %s\r\n", path);
 
-    File file = fs.open(path, FILE_APPEND);
-    if (!file) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open for appending: %s", path);
-      return;
-    }
-    if (file.println(message)) {
-      ESP_LOGV(tag, "Message appended to %s", path);
-    } 
-    else {
-      ESP_LOGE(tag, "Append failed: %s", path);
-    }
-    file.close();
-    noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+// Copy engine. One large buffer for the whole copy: reads and writes go to the same card over
+// the same bus, so a ping-pong pair couldn't overlap them, fewer and bigger transfers is the win.
+#pragma region COPY
+static uint8_t* allocCopyBuffer(size_t& cap) {
+  for (cap = SD_COPY_BUFFER_BYTES; cap >= 4096; cap /= 2) {
+    uint8_t* buf = (uint8_t*)heap_caps_malloc(cap, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    if (buf) return buf;
   }
+  cap = 0;
+  return nullptr;
 }
-void PocketmageSDMMC::renameFile(fs::FS &fs, const char *path1, const char *path2) {
-  if (noSD_) {
-    OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return;
-  }
-  else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-    noTimeout = true;
-    ESP_LOGI(tag, "Renaming file %s to %s\r\n", path1, path2);
 
-    if (fs.rename(path1, path2)) {
-      ESP_LOGV(tag, "Renamed %s to %s\r\n", path1, path2);
-    } 
-    else {
-      ESP_LOGE(tag, "Rename failed: %s to %s", path1, path2);
-    }
-    noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  }
-}
-void PocketmageSDMMC::deleteFile(fs::FS &fs, const char *path) {
-  if (noSD_) {
-    OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return;
-  }
-  else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-    noTimeout = true;
-    ESP_LOGI(tag, "Deleting file: %s\r\n", path);
-    if (fs.remove(path)) {
-      ESP_LOGV(tag, "File deleted: %s", path);
-    } 
-    else {
-      ESP_LOGE(tag, "Delete failed for %s", path);
-    }
-    noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  }
-}
-bool PocketmageSDMMC::readBinaryFile(const char* path, uint8_t* buf, size_t len) {
-  if (noSD_) {
-      OLED().oledWord("OP FAILED - No SD!");
-    delay(5000);
-    return false;
-  }
+bool PocketmageSD::copyPath(String src, String dst, CopyProgress progress) {
+  if (getNoSD() || !global_fs) return false;
 
-  setCpuFrequencyMhz(240  );
-  if (noTimeout)
-    noTimeout = true;
-    
-  File f = global_fs->open(path, "r");
-  if (!f || f.isDirectory()) {
-    if (noTimeout)
-      noTimeout = false;
-    ESP_LOGE(tag, "Failed to open file: %s", path);
+  SDSession session;
+
+  size_t cap;
+  uint8_t* buf = allocCopyBuffer(cap);
+  if (!buf) {
+    ESP_LOGE(TAG, "No memory for a copy buffer");
     return false;
   }
 
-  size_t n = f.read(buf, len);
-  f.close();
-
-  if (noTimeout)
-    noTimeout = false;
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-  return n == len;
+  size_t copied = 0;
+  ulong  start  = millis();
+  bool ok = PM_STORE().copy(src.c_str(), dst.c_str(), buf, cap, [&](size_t done, size_t total) {
+    copied = done;
+    if (progress) progress(done, total);
+    vTaskDelay(1);   // Long copies still let the idle task feed the watchdog
+  });
+  heap_caps_free(buf);
+
+  if (ok)
+    ESP_LOGI(TAG, "Copied %u bytes %s -> %s in %lu ms (%u byte buffer)", copied, src.c_str(),
+             dst.c_str(), millis() - start, cap);
+  else
+    ESP_LOGE(TAG, "Copy failed after %u bytes: %s -> %s", copied, src.c_str(), dst.c_str());
+  return ok;
 }
-size_t PocketmageSDMMC::getFileSize(const char* path) {
-  if (noSD_)
-    return 0;
 
-  File f = global_fs->open(path, "r");
-  if (!f)
-    return 0;
-  size_t size = f.size();
-  f.close();
-  return size;
+void PocketmageSD::oledCopyProgress(size_t done, size_t total) {
+  static int shown = -1;
+  int percent = total ? (int)((uint64_t)done * 100 / total) : 100;
+  if (percent == shown) return;   // The OLED is slower than a buffer of copying
+  shown = percent;
+  OLED().oledWord("Copying " + String(percent) + "%");
 }
 #pragma endregion
 
 
-// SDSPI uses standard SPI communication for compatibility
-#pragma region SDSPI
+// File operations for apps. SDMMC and SDSPI only differ in how setupSD() mounts the card,
+// after that everything goes through global_fs, so there is one implementation for both.
+#pragma region SD
 // Access for other apps
-PocketmageSDSPI& PM_SDSPI() { return pm_sdspi; }
+PocketmageSD& PM_SDAUTO() { return pm_sd; }
+
+PocketmageSD::MountStats PocketmageSD::getMountStats() { return mountStats; }
 
-void PocketmageSDSPI::saveFile() {
+void PocketmageSD::saveFile() {
   if (getNoSD()) {
     OLED().oledWord("SAVE FAILED - No SD!");
     delay(5000);
     return;
   }
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
   String textToSave = vectorToString();
 
   if (getEditingFile().isEmpty() || getEditingFile() == "-")
@@ -1080,102 +1376,52 @@ void PocketmageSDSPI::saveFile() {
   if (!getEditingFile().startsWith("/"))
     setEditingFile("/" + getEditingFile());
 
-  writeFile(SD, getEditingFile().c_str(), textToSave.c_str());
-  writeMetadata(getEditingFile());
-
-  keypad.enableInterrupts();
+  {
+    SDSession session;
 
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+    writeFile(*global_fs, getEditingFile().c_str(), textToSave.c_str());
+    writeMetadata(getEditingFile());
+  }
 
-  SDActive = false;
+  keypad.enableInterrupts();
 }
-void PocketmageSDSPI::writeMetadata(const String& path) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  File file = global_fs->open(path);
-  if (!file || file.isDirectory()) {
+void PocketmageSD::writeMetadata(const String& path, long charCount) {
+  // Get file size
+  long fileSizeBytes;
+  {
+    SDSession session;
+    fileSizeBytes = PM_STORE().fileSize(path.c_str());
+  }
+  if (fileSizeBytes < 0) {
     OLED().oledWord("META WRITE ERR");
     delay(1000);
     ESP_LOGE(TAG, "Invalid file for metadata: %s", path.c_str());
     return;
   }
 
-  // Get file size
-  size_t fileSizeBytes = file.size();
-  file.close();
-
-  // Format size string
-  String fileSizeStr = String(fileSizeBytes) + " Bytes";
+  SDSession session;
 
-  // Get line and char counts
-  int charCount =
-      countVisibleChars(PM_SDSPI().readFileToString(SD, path.c_str()));
-  String charStr = String(charCount) + " Char";
+  // Get char count, callers that already know it skip re-reading the file
+  if (charCount < 0)
+    charCount = countVisibleChars(readFileToString(*global_fs, path.c_str()));
 
   // Get current time from RTC
   DateTime now = CLOCK().nowDT();
   char timestamp[20];
-  sprintf(timestamp, "%04d%02d%02d-%02d%02d",
-          now.year(), now.month(), now.day(),
-          now.hour(), now.minute());
-
-  // Compose new metadata line
-  String newEntry = path + "|" + timestamp + "|" + fileSizeStr + "|" + charStr;
-
-  const char* metaPath = SYS_METADATA_FILE;
-
-  // Read existing metadata
-  File metaFile = global_fs->open(metaPath, FILE_READ);
-  String updatedMeta;
-  bool replaced = false;
-
-  if (metaFile) {
-    while (metaFile.available()) {
-      String line = metaFile.readStringUntil('\n');
-      if (line.startsWith(path + "|")) {
-        updatedMeta += newEntry + "\n";
-        replaced = true;
-      } else if (line.length() > 1) {
-        updatedMeta += line + "\n";
-      }
-    }
-    metaFile.close();
-  }
-
-  if (!replaced) {
-    updatedMeta += newEntry + "\n";
-  }
-
-  // Write back metadata
-  metaFile = global_fs->open(metaPath, FILE_WRITE);
-  if (!metaFile) {
-    ESP_LOGE(TAG, "Failed to open metadata file for writing: %s", metaPath);
-    return;
-  }
-
-  metaFile.print(updatedMeta);
-  metaFile.close();
-  ESP_LOGI(TAG, "Metadata updated");
-
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+  sprintf(timestamp, "%04d%02d%02d-%02d%02d", now.year(), now.month(), now.day(), now.hour(),
+          now.minute());
 
-  SDActive = false;
+  // One record rewritten in place
+  if (PM_META().put(path, timestamp, fileSizeBytes, charCount))
+    ESP_LOGI(TAG, "Metadata updated");
 }
-void PocketmageSDSPI::loadFile(bool showOLED) {
+void PocketmageSD::loadFile(bool showOLED) {
   if (getNoSD()) {
     OLED().oledWord("LOAD FAILED - No SD!");
     delay(5000);
     return;
   }
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
   keypad.disableInterrupts();
 
   if (showOLED)
@@ -1184,8 +1430,12 @@ void PocketmageSDSPI::loadFile(bool showOLED) {
   if (!getEditingFile().startsWith("/"))
     setEditingFile("/" + getEditingFile());
 
-  String text = readFileToString(SD, getEditingFile().c_str());
-  stringToVector(text);
+  {
+    SDSession session;
+
+    String text = readFileToString(*global_fs, getEditingFile().c_str());
+    stringToVector(text);
+  }
 
   keypad.enableInterrupts();
 
@@ -1194,92 +1444,44 @@ void PocketmageSDSPI::loadFile(bool showOLED) {
     delay(200);
   }
 
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-  SDActive = false;
 }
-void PocketmageSDSPI::delFile(String fileName) {
-  if (PM_SDSPI().getNoSD()) {
+void PocketmageSD::delFile(String fileName) {
+  if (getNoSD()) {
     OLED().oledWord("DELETE FAILED - No SD!");
     delay(5000);
     return;
   } else {
-    SDActive = true;
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-
     keypad.disableInterrupts();
     // OLED().oledWord("Deleting File: " + fileName);
 
     if (!fileName.startsWith("/"))
       fileName = "/" + fileName;
 
-    PM_SDSPI().deleteFile(SD, fileName.c_str());
+    {
+      SDSession session;
 
-    // Delete metadata
-    PM_SDSPI().deleteMetadata(fileName);
+      deleteFile(*global_fs, fileName.c_str());
+
+      // Delete metadata
+      deleteMetadata(fileName);
+    }
 
     delay(1000);
     keypad.enableInterrupts();
-
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-    SDActive = false;
   }
 }
-void PocketmageSDSPI::deleteMetadata(String path) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  const char* metaPath = SYS_METADATA_FILE;
-
-  // Open metadata file for reading
-  File metaFile = global_fs->open(metaPath, FILE_READ);
-  if (!metaFile) {
-    ESP_LOGE(TAG, "Metadata file not found: %s", metaPath);
-    return;
-  }
-
-  // Store lines that don't match the given path
-  std::vector<String> keptLines;
-  while (metaFile.available()) {
-    String line = metaFile.readStringUntil('\n');
-    if (!line.startsWith(path + "|")) {
-      keptLines.push_back(line);
-    }
-  }
-  metaFile.close();
-
-  // Delete original metadata file
-  global_fs->remove(metaPath);
+void PocketmageSD::deleteMetadata(String path) {
+  SDSession session;
 
-  // Recreate file and write kept lines
-  File writeFile = global_fs->open(metaPath, FILE_WRITE);
-  if (!writeFile) {
-    ESP_LOGE(TAG, "Failed to recreate metadata file. %s", writeFile.path());
-    return;
-  }
-
-  for (const String& line : keptLines) {
-    writeFile.println(line);
-  }
-
-  writeFile.close();
+  PM_META().remove(path);
   ESP_LOGI(TAG, "Metadata entry deleted (if it existed).");
 }
-void PocketmageSDSPI::renFile(String oldFile, String newFile) {
-  if (PM_SDSPI().getNoSD()) {
+void PocketmageSD::renFile(String oldFile, String newFile) {
+  if (getNoSD()) {
     OLED().oledWord("RENAME FAILED - No SD!");
     delay(5000);
     return;
   } else {
-    SDActive = true;
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-
     keypad.disableInterrupts();
 
     if (!oldFile.startsWith("/"))
@@ -1287,12 +1489,18 @@ void PocketmageSDSPI::renFile(String oldFile, String newFile) {
     if (!newFile.startsWith("/"))
       newFile = "/" + newFile;
 
-    if (global_fs->rename(oldFile.c_str(), newFile.c_str())) {
-      OLED().oledWord(oldFile + " -> " + newFile);
-      delay(1000);
+    bool renamed;
+    {
+      SDSession session;
 
+      renamed = PM_STORE().rename(oldFile.c_str(), newFile.c_str());
       // Update metadata
-      PM_SDSPI().renMetadata(oldFile, newFile);
+      if (renamed) renMetadata(oldFile, newFile);
+    }
+
+    if (renamed) {
+      OLED().oledWord(oldFile + " -> " + newFile);
+      delay(1000);
     } else {
       ESP_LOGE(TAG, "Rename failed: %s -> %s", oldFile.c_str(), newFile.c_str());
       OLED().oledWord("RENAME FAILED");
@@ -1300,75 +1508,20 @@ void PocketmageSDSPI::renFile(String oldFile, String newFile) {
     }
 
     keypad.enableInterrupts();
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
   }
 }
-void PocketmageSDSPI::renMetadata(String oldPath, String newPath) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  const char* metaPath = SYS_METADATA_FILE;
-
-  // Open metadata file for reading
-  File metaFile = global_fs->open(metaPath, FILE_READ);
-  if (!metaFile) {
-    ESP_LOGE(TAG, "Metadata file not found: %s", metaPath);
-    return;
-  }
-
-  std::vector<String> updatedLines;
-
-  while (metaFile.available()) {
-    String line = metaFile.readStringUntil('\n');
-
-    if (line.startsWith(oldPath + "|")) {
-      int separatorIndex = line.indexOf('|');
-      if (separatorIndex != -1) {
-        String rest = line.substring(separatorIndex);
-        line = newPath + rest;
-      } else {
-        line = newPath;
-      }
-    }
-
-    updatedLines.push_back(line);
-  }
+void PocketmageSD::renMetadata(String oldPath, String newPath) {
+  SDSession session;
 
-  metaFile.close();
-
-  // Delete old metadata file
-  global_fs->remove(metaPath);
-
-  // Recreate file and write updated lines
-  File writeFile = global_fs->open(metaPath, FILE_WRITE);
-  if (!writeFile) {
-    ESP_LOGE(TAG, "Failed to recreate metadata file: %s", metaPath);
-    return;
-  }
-
-  for (const String& l : updatedLines) {
-    writeFile.println(l);
-  }
-
-  writeFile.close();
+  PM_META().rename(oldPath, newPath);
   ESP_LOGI(TAG, "Metadata updated for renamed file.");
-
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
 }
-void PocketmageSDSPI::copyFile(String oldFile, String newFile) {
-  if (PM_SDSPI().getNoSD()) {
+void PocketmageSD::copyFile(String oldFile, String newFile) {
+  if (getNoSD()) {
     OLED().oledWord("COPY FAILED - No SD!");
     delay(5000);
     return;
   } else {
-    SDActive = true;
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-
     keypad.disableInterrupts();
     OLED().oledWord("Loading File");
 
@@ -1377,186 +1530,171 @@ void PocketmageSDSPI::copyFile(String oldFile, String newFile) {
     if (!newFile.startsWith("/"))
       newFile = "/" + newFile;
 
-    // Read source file
-    File src = global_fs->open(oldFile.c_str(), FILE_READ);
-    if (!src || src.isDirectory()) {
-      ESP_LOGE(TAG, "Failed to open source file: %s", oldFile.c_str());
-      OLED().oledWord("COPY FAILED");
-      keypad.enableInterrupts();
-      return;
-    }
+    {
+      SDSession session;
 
-    // Write destination file
-    File dst = global_fs->open(newFile.c_str(), FILE_WRITE);
-    if (!dst) {
-      ESP_LOGE(TAG, "Failed to open destination file: %s", newFile.c_str());
-      src.close();
-      OLED().oledWord("COPY FAILED");
-      keypad.enableInterrupts();
-      return;
-    }
+      if (!copyPath(oldFile, newFile, oledCopyProgress)) {
+        OLED().oledWord("COPY FAILED");
+        keypad.enableInterrupts();
+        return;
+      }
 
-    while (src.available()) {
-      dst.write(src.read());
+      // Write metadata
+      writeMetadata(newFile);
     }
 
-    src.close();
-    dst.close();
-
     OLED().oledWord("Saved: " + newFile);
-
-    // Write metadata
-    PM_SDSPI().writeMetadata(newFile);
-
     delay(1000);
     keypad.enableInterrupts();
-
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
   }
 }
-void PocketmageSDSPI::appendToFile(String path, String inText) {
+void PocketmageSD::appendToFile(String path, String inText) {
   if (getNoSD()) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
+  SDSession session;
 
   keypad.disableInterrupts();
 
   if (!path.startsWith("/"))
     path = "/" + path;
 
-  File file = global_fs->open(path.c_str(), FILE_APPEND);
-  if (!file) {
+  String line = inText + "\r\n";   // what println() wrote
+  if (!PM_STORE().appendFile(path.c_str(), line.c_str(), line.length())) {
     OLED().oledWord("APPEND FAILED");
     keypad.enableInterrupts();
-    SDActive = false;
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     return;
   }
 
-  file.print(inText);
-  file.close();
-
-  // Write MetaData
-  writeMetadata(path);
+  // Write MetaData, the char count grows by what was appended
+  PocketmageMetaStore::Record rec;
+  if (PM_META().get(path, rec))
+    writeMetadata(path, rec.charCount + countVisibleChars(inText));
+  else
+    writeMetadata(path);
 
   keypad.enableInterrupts();
+}
+void PocketmageSD::writeLines(String path, const std::vector<String>& lines, bool append) {
+  if (getNoSD()) {
+    OLED().oledWord("OP FAILED - No SD!");
+    delay(5000);
+    return;
+  }
 
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+  SDSession session;
+
+  keypad.disableInterrupts();
+
+  if (!path.startsWith("/"))
+    path = "/" + path;
+
+  // Appending keeps counting from the stored total
+  long charCount = 0;
+  if (append) {
+    PocketmageMetaStore::Record rec;
+    charCount = PM_META().get(path, rec) ? (long)rec.charCount : -1;
+  }
 
-  SDActive = false;
+  // One open, lines coalesced into sector-sized writes
+  long written = PM_STORE().writeLines(path.c_str(), lines, append);
+  if (written < 0) {
+    ESP_LOGE(TAG, "Failed to write %s", path.c_str());
+    OLED().oledWord("WRITE FAILED");
+    keypad.enableInterrupts();
+    return;
+  }
+  ESP_LOGI(TAG, "Wrote %u lines to %s", lines.size(), path.c_str());
+
+  // Write MetaData once for the whole batch
+  writeMetadata(path, charCount < 0 ? -1 : charCount + written);
+
+  keypad.enableInterrupts();
 }
 
 // ===================== low level functions =====================
-// Low-Level SDMMC Operations switch to using internal fs::FS*
-void PocketmageSDSPI::listDir(fs::FS &fs, const char *dirname) {
+// Low-Level Operations switch to using internal fs::FS*
+void PocketmageSD::listDir(fs::FS &fs, const char *dirname) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
     noTimeout = true;
     ESP_LOGI(tag, "Listing directory %s\r\n", dirname);
 
-    File root = fs.open(dirname);
-    if (!root) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open directory: %s", root.path());
-      return;
-    }
-    if (!root.isDirectory()) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Not a directory: %s", root.path());
-      
-      return;
-    }
+    // Served from the directory cache, the card is only read if dirname changed since last time
+    PocketmageDirCache::ListingPtr entries = PM_DIRS().list(dirname);
 
     // Reset fileIndex and initialize filesList with "-"
     fileIndex_ = 0; // Reset fileIndex
     for (int i = 0; i < MAX_FILES; i++) {
-      filesList_[i] = "-";
+      filesList[i] = "-";
     }
 
-    File file = root.openNextFile();
-    while (file && fileIndex_ < MAX_FILES) {
-      if (!file.isDirectory()) {
-        String fileName = String(file.name());
-        
-        // Check if file is in the exclusion list
-        bool excluded = false;
-        for (const String &excludedFile : excludedFiles_) {
-          if (fileName.equals(excludedFile) || ("/"+fileName).equals(excludedFile)) {
-            excluded = true;
-            break;
-          }
-        }
+    for (const PocketmageDirCache::Entry& e : *entries) {
+      if (fileIndex_ >= MAX_FILES) break;
+      if (e.isDir) continue;
 
-        if (!excluded) {
-          filesList_[fileIndex_++] = fileName; // Store file name if not excluded
+      // Check if file is in the exclusion list
+      bool excluded = false;
+      for (const String &excludedFile : excludedFiles_) {
+        if (e.name.equals(excludedFile) || ("/"+e.name).equals(excludedFile)) {
+          excluded = true;
+          break;
         }
       }
-      file = root.openNextFile();
-    }
 
-    // for (int i = 0; i < fileIndex_; i++) { // Only print valid entries
-    //   Serial.println(filesList_[i]);       // NOTE: This prints out valid files
-    // }
+      if (!excluded) {
+        filesList[fileIndex_++] = e.name; // Store file name if not excluded
+      }
+    }
 
     noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
   }
 }
-void PocketmageSDSPI::readFile(fs::FS &fs, const char *path) {
+void PocketmageSD::readFile(fs::FS &fs, const char *path) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
+    SDSession session;
     noTimeout = true;
     ESP_LOGI(tag, "Reading file %s\r\n", path);
 
-    File file = fs.open(path);
-    if (!file || file.isDirectory()) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open file for reading: %s", file.path());
-      return;
-    }
+    if (PM_STORE().fileSize(path) < 0)
+      ESP_LOGE(tag, "Failed to open file for reading: %s", path);
 
-    file.close();
     noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
   }
 }
-String PocketmageSDSPI::readFileToString(fs::FS &fs, const char *path) {
+String PocketmageSD::readFileToString(fs::FS &fs, const char *path) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return "";
   }
   else { 
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-
     noTimeout = true;
     ESP_LOGI(tag, "Reading file: %s\r\n", path);
 
-    File file = fs.open(path);
-    if (!file || file.isDirectory()) {
+    // Read in blocks straight into the String, reserved up front so it grows once
+    String content;
+    bool ok;
+    {
+      SDSession session;
+
+      long size = PM_STORE().fileSize(path);
+      if (size > 0) content.reserve(size);
+      ok = PM_STORE().readFile(path, [&content](const char* p, size_t n) { content.concat(p, n); });
+    }
+    if (!ok) {
       noTimeout = false;
       ESP_LOGE(tag, "Failed to open file for reading: %s", path);
       OLED().oledWord("Load Failed");
@@ -1564,151 +1702,191 @@ String PocketmageSDSPI::readFileToString(fs::FS &fs, const char *path) {
       return "";  // Return an empty string on failure
     }
 
-    ESP_LOGI(tag, "Reading from file: %s", file.path());
-    String content = file.readString();
-
-    file.close();
-    EINK().setFullRefreshAfter(FULL_REFRESH_AFTER); //Force a full refresh
     noTimeout = false;
     return content;  // Return the complete String
   }
 }
-void PocketmageSDSPI::writeFile(fs::FS &fs, const char *path, const char *message) {
+void PocketmageSD::writeFile(fs::FS &fs, const char *path, const char *message) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
     noTimeout = true;
     ESP_LOGI(tag, "Writing file: %s\r\n", path);
     delay(200);
 
-    File file = fs.open(path, FILE_WRITE);
-    if (!file) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open %s for writing", path);
-      return;
-    }
-    if (file.print(message)) {
+    SDSession session;
+
+    if (PM_STORE().writeFile(path, message, strlen(message))) {
       ESP_LOGV(tag, "File written %s", path);
     } 
     else {
       ESP_LOGE(tag, "Write failed for %s", path);
     }
-    file.close();
     noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
   }
 }
-void PocketmageSDSPI::appendFile(fs::FS &fs, const char *path, const char *message) {
+void PocketmageSD::appendFile(fs::FS &fs, const char *path, const char *message) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
+    SDSession session;
     noTimeout = true;
     ESP_LOGI(tag, "Appending to file: %s\r\n", path);
 
-    File file = fs.open(path, FILE_APPEND);
-    if (!file) {
-      noTimeout = false;
-      ESP_LOGE(tag, "Failed to open for appending: %s", path);
-      return;
-    }
-    if (file.println(message)) {
+    String line = String(message) + "\r\n";   // what println() wrote
+    if (PM_STORE().appendFile(path, line.c_str(), line.length())) {
       ESP_LOGV(tag, "Message appended to %s", path);
     } 
     else {
       ESP_LOGE(tag, "Append failed: %s", path);
     }
-    file.close();
     noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
   }
 }
-void PocketmageSDSPI::renameFile(fs::FS &fs, const char *path1, const char *path2) {
+void PocketmageSD::renameFile(fs::FS &fs, const char *path1, const char *path2) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
+    SDSession session;
     noTimeout = true;
     ESP_LOGI(tag, "Renaming file %s to %s\r\n", path1, path2);
 
-    if (fs.rename(path1, path2)) {
+    if (PM_STORE().rename(path1, path2)) {
       ESP_LOGV(tag, "Renamed %s to %s\r\n", path1, path2);
     } 
     else {
       ESP_LOGE(tag, "Rename failed: %s to %s", path1, path2);
     }
     noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
   }
 }
-void PocketmageSDSPI::deleteFile(fs::FS &fs, const char *path) {
+void PocketmageSD::deleteFile(fs::FS &fs, const char *path) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    pocketmage::setCpuSpeed(240);
-    delay(50);
+    SDSession session;
     noTimeout = true;
     ESP_LOGI(tag, "Deleting file: %s\r\n", path);
-    if (fs.remove(path)) {
+    if (PM_STORE().remove(path)) {
       ESP_LOGV(tag, "File deleted: %s", path);
     } 
     else {
       ESP_LOGE(tag, "Delete failed for %s", path);
     }
     noTimeout = false;
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
   }
 }
-bool PocketmageSDSPI::readBinaryFile(const char* path, uint8_t* buf, size_t len) {
+bool PocketmageSD::readBinaryFile(const char* path, uint8_t* buf, size_t len) {
   if (noSD_) {
     OLED().oledWord("OP FAILED - No SD!");
     delay(5000);
     return false;
   }
 
-  setCpuFrequencyMhz(240);
+  SDSession session;
   if (noTimeout) noTimeout = true;
 
-  File f = global_fs->open(path, FILE_READ);
-  if (!f || f.isDirectory()) {
-    noTimeout = false;
-    ESP_LOGE(tag, "Failed to open file: %s", path);
-    return false;
-  }
-
-  size_t n = f.read(buf, len);
-  f.close();
+  bool ok = PM_STORE().readBinary(path, buf, len);
+  if (!ok)
+    ESP_LOGE(tag, "Failed to read %u bytes from %s", len, path);
 
   noTimeout = false;
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
 
-  return n == len;
+  return ok;
 }
-size_t PocketmageSDSPI::getFileSize(const char* path) {
+size_t PocketmageSD::getFileSize(const char* path) {
   if (noSD_)
     return 0;
 
-  File f = global_fs->open(path, "r");
-  if (!f)
-    return 0;
-  size_t size = f.size();
-  f.close();
-  return size;
+  SDSession session;
+  long size = PM_STORE().fileSize(path);
+  return size < 0 ? 0 : (size_t)size;
+}
+
+// ===================== benchmark =====================
+// Small-write and small-read throughput of a plain File against a PocketmageFile,
+// one line per result for the terminal
+std::vector<String> PocketmageSD::benchmarkBuffered() {
+  static constexpr const char* BENCH_FILE  = "/sys/bench.tmp";
+  static constexpr size_t      BENCH_BYTES = 64 * 1024;
+  static constexpr size_t      WRITE_CHUNK = 16;
+
+  std::vector<String> out;
+  if (noSD_ || !global_fs) {
+    out.push_back("No SD!");
+    return out;
+  }
+
+  SDSession session;
+  noTimeout = true;
+
+  uint8_t chunk[WRITE_CHUNK];
+  for (size_t i = 0; i < WRITE_CHUNK; i++) chunk[i] = 'a' + i;
+
+  auto kbps = [](size_t bytes, uint32_t us) -> String {
+    return String(us ? (bytes * 1000000.0f / 1024.0f) / us : 0.0f, 1) + " KB/s";
+  };
+
+  // Writes of WRITE_CHUNK bytes
+  uint32_t rawWrite = 0, bufWrite = 0;
+  {
+    File f = global_fs->open(BENCH_FILE, FILE_WRITE);
+    uint32_t t0 = micros();
+    for (size_t n = 0; f && n < BENCH_BYTES; n += WRITE_CHUNK) f.write(chunk, WRITE_CHUNK);
+    f.close();
+    rawWrite = micros() - t0;
+  }
+  {
+    PocketmageFile f;
+    f.open(BENCH_FILE, FILE_WRITE);
+    uint32_t t0 = micros();
+    for (size_t n = 0; f && n < BENCH_BYTES; n += WRITE_CHUNK) f.write(chunk, WRITE_CHUNK);
+    f.close();
+    bufWrite = micros() - t0;
+  }
+
+  // Reads of one byte
+  uint32_t rawRead = 0, bufRead = 0;
+  size_t rawBytes = 0, bufBytes = 0;
+  {
+    File f = global_fs->open(BENCH_FILE);
+    uint32_t t0 = micros();
+    while (f && f.read() >= 0) rawBytes++;
+    f.close();
+    rawRead = micros() - t0;
+  }
+  {
+    PocketmageFile f;
+    f.open(BENCH_FILE);
+    uint32_t t0 = micros();
+    while (f && f.read() >= 0) bufBytes++;
+    f.close();
+    bufRead = micros() - t0;
+  }
+
+  global_fs->remove(BENCH_FILE);
+  PM_DIRS().invalidate(BENCH_FILE);
+  noTimeout = false;
+
+  ESP_LOGI(tag, "bench write %u/%u us, read %u/%u us", rawWrite, bufWrite, rawRead, bufRead);
+
+  out.push_back(String(SD_SPI_COMPATIBILITY ? "SDSPI" : "SD_MMC") + ", " + String(BENCH_BYTES / 1024) +
+                " KB, " + String(SD_BUFFER_BYTES) + " B buffer");
+  out.push_back(String(WRITE_CHUNK) + " B writes: " + kbps(BENCH_BYTES, rawWrite) + " -> " + kbps(BENCH_BYTES, bufWrite));
+  out.push_back("1 B reads:   " + kbps(rawBytes, rawRead) + " -> " + kbps(bufBytes, bufRead));
+  out.push_back("Boot mount " + String(mountStats.mountMs) + " ms" + (mountStats.fastPath ? " (fast)" : "") +
+                ", layout " + String(mountStats.layoutMs) + " ms");
+  return out;
 }
-#pragma endregion
\ No newline at end of file
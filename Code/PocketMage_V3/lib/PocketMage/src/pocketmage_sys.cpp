@@ -89,43 +89,51 @@ void deepSleep(bool alternateScreenSaver) {
   BZ().playJingle(Jingles::Shutdown);
 
   if (alternateScreenSaver == false) {
-    SDActive = true;
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-
-    // Check if there are custom screensavers
-    File dir = global_fs->open("/assets/backgrounds");
+    static uint8_t buf[320 * 240];  // Declare as static to avoid stack overflow :D
     std::vector<String> binFiles;
+    String shown;   // custom screensaver read into buf
+
+    // The session only covers the card, drawing and refreshing wait for the panel
+    {
+      SDSession session;
+
+      // Check if there are custom screensavers
+      File dir = global_fs->open("/assets/backgrounds");
+
+      if (dir) {
+        File file;
+        while ((file = dir.openNextFile())) {
+          String name = file.name();
+          if (name.endsWith(".bin"))
+            binFiles.push_back(name);
+          file.close();
+        }
+        dir.close();
+      }
 
-    if (dir) {
-      File file;
-      while ((file = dir.openNextFile())) {
-        String name = file.name();
-        if (name.endsWith(".bin"))
-          binFiles.push_back(name);
-        file.close();
+      if (!binFiles.empty()) {
+        int fileIndex = esp_random() % binFiles.size();
+        String path = "/assets/backgrounds/" + binFiles[fileIndex];
+        File f = global_fs->open(path);
+        if (f) {
+          f.read(buf, sizeof(buf));
+          f.close();
+          shown = binFiles[fileIndex];
+        }
       }
-      dir.close();
     }
 
     display.setFullWindow();
 
     // Use custom screensavers
     if (!binFiles.empty()) {
-      int fileIndex = esp_random() % binFiles.size();
-      String path = "/assets/backgrounds/" + binFiles[fileIndex];
-      File f = global_fs->open(path);
-      if (f) {
-        static uint8_t buf[320 * 240];  // Declare as static to avoid stack overflow :D
-        f.read(buf, sizeof(buf));
-        f.close();
-
+      if (shown.length() > 0) {
         // Show file
         display.drawBitmap(0, 0, buf, 320, 240, GxEPD_BLACK);
         display.setFont(&FreeMonoBold9pt7b);
         display.setTextColor(GxEPD_BLACK);
         display.setCursor(5, display.height() - 5);
-        display.print(binFiles[fileIndex].c_str());
+        display.print(shown.c_str());
       }
     }
     // Use standard screensavers
@@ -136,10 +144,6 @@ void deepSleep(bool alternateScreenSaver) {
       display.drawBitmap(0, 0, ScreenSaver_allArray[randomScreenSaver_], 320, 240, GxEPD_BLACK);
     }
 
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
-
     EINK().multiPassRefresh(2);
   } else {
     // Display alternate screensaver
@@ -150,7 +154,8 @@ void deepSleep(bool alternateScreenSaver) {
   // essential to display next app correctly
   display.setFullWindow();
   display.fillScreen(GxEPD_WHITE);
-  // Put E-Ink to sleep
+  // Put E-Ink to sleep once the last frame is on the panel
+  EINK().waitForFlush();
   display.hibernate();
 
   // Save last state
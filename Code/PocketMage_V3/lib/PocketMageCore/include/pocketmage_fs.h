@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ===================== STORAGE BACKEND =====================
+// The file operations the storage service needs. The device implements it over fs::FS
+// (SD_MMC or SDSPI, see pocketmage_sd.cpp), the native tests over a host directory.
+// Paths are absolute ("/notes/a.txt"), modes are the fopen ones the firmware uses: "r", "w", "a", "r+".
+class PocketmageFsFile {
+public:
+  virtual ~PocketmageFsFile() {}   // closes the file
+
+  virtual size_t read(uint8_t* buf, size_t len) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) = 0;
+  virtual bool   seek(uint32_t pos) = 0;
+  virtual size_t position() = 0;
+  virtual size_t size() = 0;
+  virtual bool   isDirectory() = 0;
+};
+
+class PocketmageFs {
+public:
+  struct Entry {
+    std::string name;           // base name, no path
+    bool        isDir = false;
+    uint32_t    size  = 0;
+    time_t      mtime = 0;
+  };
+
+  virtual ~PocketmageFs() {}
+
+  // nullptr if it can't be opened. Directories open read-only, for isDirectory().
+  virtual std::unique_ptr<PocketmageFsFile> open(const char* path, const char* mode = "r") = 0;
+  virtual bool exists(const char* path) = 0;
+  virtual bool mkdir(const char* path) = 0;
+  virtual bool rmdir(const char* path) = 0;
+  virtual bool remove(const char* path) = 0;
+  virtual bool rename(const char* from, const char* to) = 0;
+  virtual bool list(const char* dir, std::vector<Entry>& out) = 0;   // false if dir isn't a directory
+};
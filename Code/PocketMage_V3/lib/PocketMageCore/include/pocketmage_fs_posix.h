@@ -0,0 +1,22 @@
+#pragma once
+#include "pocketmage_fs.h"
+
+// ===================== POSIX BACKEND =====================
+// PocketmageFs over a directory of the host, "/" is root. Used by the native tests.
+class PocketmagePosixFs : public PocketmageFs {
+public:
+  explicit PocketmagePosixFs(std::string root) : root_(std::move(root)) {}
+
+  std::unique_ptr<PocketmageFsFile> open(const char* path, const char* mode = "r") override;
+  bool exists(const char* path) override;
+  bool mkdir(const char* path) override;
+  bool rmdir(const char* path) override;
+  bool remove(const char* path) override;
+  bool rename(const char* from, const char* to) override;
+  bool list(const char* dir, std::vector<Entry>& out) override;
+
+private:
+  std::string full_(const char* path) const;
+
+  std::string root_;
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include "pocketmage_fs.h"
+#include <functional>
+
+// ===================== STORAGE SERVICE =====================
+// The file operations behind PocketmageSD, written once against a PocketmageFs so the SD card
+// and the native tests run the same code. No UI and no logging here, everything reports
+// through its return value, PocketmageSD decides what to tell the user.
+class PocketmageStore {
+public:
+  using Progress = std::function<void(size_t done, size_t total)>;   // bytes
+  using Changed  = std::function<void(const std::string& path)>;     // path was created, written or removed
+
+  explicit PocketmageStore(PocketmageFs& fs) : fs_(fs) {}
+
+  PocketmageFs& fs() { return fs_; }
+  void onChanged(Changed cb) { changed_ = std::move(cb); }
+
+  // Leading '/', no trailing '/'
+  static std::string normalize(const char* path);
+  // Printable ASCII and spaces, the char count metadata records for a file
+  static size_t countVisibleChars(const char* s, size_t len);
+
+  bool   readFile(const char* path, const std::function<void(const char*, size_t)>& sink);
+  bool   readFile(const char* path, std::string& out);
+  bool   readBinary(const char* path, uint8_t* buf, size_t len);   // true if len bytes were read
+  long   fileSize(const char* path);                               // -1: missing or a directory
+  bool   writeFile(const char* path, const char* data, size_t len);
+  bool   appendFile(const char* path, const char* data, size_t len);
+  // One open for the batch, each line gets a '\n'. Visible chars written, -1 on failure.
+  template <class Lines>
+  long   writeLines(const char* path, const Lines& lines, bool append = false);
+  bool   rename(const char* from, const char* to);
+  bool   remove(const char* path);
+  bool   list(const char* dir, std::vector<PocketmageFs::Entry>& out) { return fs_.list(dir, out); }
+  // A file, or a directory tree into dst, through the caller's buffer
+  bool   copy(const char* src, const char* dst, uint8_t* buf, size_t cap, Progress progress = nullptr);
+
+  // Coalesces small writes into CHUNK byte writes
+  class Writer {
+  public:
+    static constexpr size_t CHUNK = 512;
+
+    explicit Writer(std::unique_ptr<PocketmageFsFile> file) : file_(std::move(file)) {}
+    explicit operator bool() const { return (bool)file_; }
+    void write(const char* p, size_t n);
+    bool close();   // false if any write came up short
+
+  private:
+    bool flush_();
+
+    std::unique_ptr<PocketmageFsFile> file_;
+    uint8_t                           buf_[CHUNK];
+    size_t                            used_ = 0;
+    bool                              ok_   = true;
+  };
+
+private:
+  struct CopyState {
+    uint8_t* buf;
+    size_t   cap;
+    size_t   done;
+    size_t   total;
+    Progress progress;
+  };
+
+  void   notify_(const std::string& path) { if (changed_) changed_(path); }
+  size_t treeBytes_(const std::string& dir);
+  bool   copyOne_(CopyState& st, const std::string& src, const std::string& dst);
+  bool   copyTree_(CopyState& st, const std::string& src, const std::string& dst);
+
+  PocketmageFs& fs_;
+  Changed       changed_;
+};
+
+template <class Lines>
+long PocketmageStore::writeLines(const char* path, const Lines& lines, bool append) {
+  Writer out(fs_.open(path, append ? "a" : "w"));
+  if (!out) return -1;
+
+  long chars = 0;
+  for (const auto& line : lines) {
+    chars += countVisibleChars(line.c_str(), line.length());
+    out.write(line.c_str(), line.length());
+    out.write("\n", 1);
+  }
+  bool ok = out.close();
+  notify_(normalize(path));
+  return ok ? chars : -1;
+}
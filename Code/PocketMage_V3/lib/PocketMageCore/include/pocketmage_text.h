@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ===================== TEXT MEASURING =====================
+// Ink bounds of a string, same math as Adafruit_GFX getTextBounds() but fed one char at a time,
+// without a NUL-terminated copy and without touching the display's font. FontT is laid out like
+// GFXfont (first, last, glyph[] with width, height, xAdvance, xOffset, yOffset), nullptr is the
+// built-in 6x8 font. No Arduino here, so the native tests measure with the same code.
+template <class FontT>
+struct InkBoundsT {
+  const FontT* font;
+  int16_t penX = 0;                                       // cursor x after the last glyph
+  int16_t minX = INT16_MAX, maxX = INT16_MIN;
+  int16_t minY = INT16_MAX, maxY = INT16_MIN;
+
+  explicit InkBoundsT(const FontT* f) : font(f) {}
+  void add(char c) {
+    if (font) {
+      uint8_t uc = (uint8_t)c;
+      if (uc < font->first || uc > font->last) return;
+      const auto& g = font->glyph[uc - font->first];
+      int16_t x1 = penX + g.xOffset, y1 = g.yOffset;
+      int16_t x2 = x1 + g.width - 1, y2 = y1 + g.height - 1;
+      if (x1 < minX) minX = x1;
+      if (x2 > maxX) maxX = x2;
+      if (y1 < minY) minY = y1;
+      if (y2 > maxY) maxY = y2;
+      penX += g.xAdvance;
+    } else {
+      // built-in 6x8 font
+      if (penX < minX) minX = penX;
+      if (penX + 5 > maxX) maxX = penX + 5;
+      minY = 0;
+      maxY = 7;
+      penX += 6;
+    }
+  }
+  void add(const char* s, size_t n) { for (size_t i = 0; i < n; ++i) add(s[i]); }
+
+  int16_t  x1()     const { return (maxX >= minX) ? minX : 0; }
+  int16_t  y1()     const { return (maxY >= minY) ? minY : 0; }
+  uint16_t width()  const { return (maxX >= minX) ? (maxX - minX + 1) : 0; }
+  uint16_t height() const { return (maxY >= minY) ? (maxY - minY + 1) : 0; }
+};
+
+// Longest prefix of s that fits in maxWidth, preferring to break after a space. A newline ends
+// the slice, or is the whole slice if it comes first. Each char is measured once, so wrapping a
+// line is linear in its length.
+template <class FontT>
+size_t sliceToWidth(const FontT* font, const char* s, size_t n, int maxWidth) {
+  if (!s || n == 0) return 0;
+
+  InkBoundsT<FontT> bounds(font);
+  size_t best = 0, lastSpace = SIZE_MAX;
+  size_t i = 0;
+
+  while (i < n) {
+    char c = s[i];
+
+    // newline: either end before it, or consume 1 char if it's first
+    if (c == '\n' || c == '\r') return (best > 0) ? best : 1;
+
+    if (c == ' ') lastSpace = i;
+
+    bounds.add(c);
+    if ((int)bounds.width() > maxWidth) break;
+
+    best = i + 1;
+    ++i;
+  }
+
+  const bool overflowed = (i < n);
+  if (best == 0) return 1;
+
+  if (overflowed && lastSpace != SIZE_MAX && lastSpace + 1 <= best) {
+    return lastSpace + 1;
+  }
+  return best;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ===================== TEXT SOURCES =====================
+// Line lists frames draw from, the ones that only need RAM. No Arduino here, so the native
+// tests fill the same arenas the firmware does. PROGMEM and SD sources live in frames.h.
+
+// bit flags for alignment or future options
+enum LineFlags : uint8_t { LF_NONE=0, LF_RIGHT= 1<<0, LF_CENTER= 1<<1 };
+struct LineView {
+  const char* ptr;   // points to NUL-terminated string in RAM or PROGMEM
+  uint16_t    len;   // byte length (no need to include '\0')
+  uint8_t     flags; // LineFlags
+};
+// read-only interface for any line list (PROGMEM table, arena, etc.)
+struct TextSource {
+  virtual ~TextSource() {}
+  virtual size_t   size() const = 0;
+  virtual LineView line(size_t i) const = 0; 
+  // changes whenever lines change so frames know to re-wrap; static sources keep 0
+  virtual uint32_t version() const { return 0; }
+};
+// legacy "~C~"/"~R~" prefixes become flags so nothing downstream parses them
+inline void stripAlignMarker(const char*& s, uint16_t& L, uint8_t& flags) {
+  if (L >= 3 && s[0] == '~' && s[2] == '~' && (s[1] == 'C' || s[1] == 'R')) {
+    flags |= (s[1] == 'C') ? LF_CENTER : LF_RIGHT;
+    s += 3;
+    L -= 3;
+  }
+}
+template<size_t MAX_LINES, size_t BUF_BYTES>
+struct FixedArenaSource : TextSource {
+  char     buf[BUF_BYTES];
+  uint16_t off[MAX_LINES];
+  uint16_t len_[MAX_LINES];
+  uint8_t  flags_[MAX_LINES];
+  size_t   nLines = 0;
+  size_t   used   = 0;
+  uint32_t version_ = 0;
+
+  size_t size() const override { return nLines; }
+
+  LineView line(size_t i) const override {
+    return { buf + off[i], len_[i], flags_[i] };
+  }
+
+  uint32_t version() const override { return version_; }
+
+  void clear() { nLines = 0; used = 0; version_++; }
+
+  // Returns false if out of capacity; caller can choose to drop the oldest, etc.
+  bool pushLine(const char* s, uint16_t L, uint8_t flags = LF_NONE) {
+    stripAlignMarker(s, L, flags);
+    if (nLines >= MAX_LINES || used + L + 1 > BUF_BYTES) return false;
+    memcpy(buf + used, s, L);
+    buf[used + L] = '\0';
+    off[nLines]   = (uint16_t)used;
+    len_[nLines]  = L;
+    flags_[nLines]= flags;
+    used         += L + 1;
+    nLines++;
+    version_++;
+    return true;
+  }
+};
+// Same fixed footprint as FixedArenaSource, but when lines or bytes run out the oldest lines
+// are evicted instead of refusing the push. Line slots and bytes are both rings; a line that
+// would straddle the end of buf starts again at 0 so every LineView stays contiguous.
+template<size_t MAX_LINES, size_t BUF_BYTES>
+struct RingArenaSource : TextSource {
+  static_assert(BUF_BYTES > 1 && BUF_BYTES <= 65535, "offsets are uint16_t");
+
+  char     buf[BUF_BYTES];
+  uint16_t off[MAX_LINES];
+  uint16_t len_[MAX_LINES];
+  uint8_t  flags_[MAX_LINES];
+  size_t   head   = 0;   // slot of the oldest line
+  size_t   nLines = 0;
+  size_t   start  = 0;   // byte offset of the oldest line
+  size_t   tail   = 0;   // next free byte
+  uint32_t version_ = 0;
+
+  size_t size() const override { return nLines; }
+
+  LineView line(size_t i) const override {
+    size_t slot = (head + i) % MAX_LINES;
+    return { buf + off[slot], len_[slot], flags_[slot] };
+  }
+
+  uint32_t version() const override { return version_; }
+
+  void clear() { head = nLines = start = tail = 0; version_++; }
+
+  // Drop the oldest line
+  void popFront() {
+    if (nLines == 0) return;
+    head = (head + 1) % MAX_LINES;
+    if (--nLines == 0) start = tail = 0;
+    else               start = off[head];
+    version_++;
+  }
+
+  // Always succeeds; lines longer than the arena are truncated
+  bool pushLine(const char* s, uint16_t L, uint8_t flags = LF_NONE) {
+    stripAlignMarker(s, L, flags);
+    if (L > BUF_BYTES - 1) L = BUF_BYTES - 1;
+    const size_t need = (size_t)L + 1;
+
+    if (nLines >= MAX_LINES) popFront();
+
+    // find room, evicting from the front until the line fits; the write position never
+    // catches up with start while wrapped, so tail < start always means "wrapped"
+    size_t at;
+    for (;;) {
+      if (nLines == 0)                               { at = 0;    break; }
+      if (tail >= start && tail + need <= BUF_BYTES) { at = tail; break; }
+      if (tail >= start && need < start)             { at = 0;    break; }
+      if (tail <  start && tail + need < start)      { at = tail; break; }
+      popFront();
+    }
+
+    memcpy(buf + at, s, L);
+    buf[at + L] = '\0';
+    size_t slot   = (head + nLines) % MAX_LINES;
+    off[slot]     = (uint16_t)at;
+    len_[slot]    = L;
+    flags_[slot]  = flags;
+    if (nLines == 0) start = at;
+    tail = at + need;
+    nLines++;
+    version_++;
+    return true;
+  }
+};
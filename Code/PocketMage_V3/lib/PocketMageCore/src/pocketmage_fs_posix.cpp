@@ -0,0 +1,85 @@
+// Only the native build has a POSIX filesystem to back this
+#if !defined(ARDUINO)
+#include "pocketmage_fs_posix.h"
+#include <cstdio>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// A stdio FILE, or a directory handle with no FILE behind it
+class PosixFile : public PocketmageFsFile {
+public:
+  PosixFile(FILE* f, bool dir) : f_(f), dir_(dir) {}
+  ~PosixFile() override { if (f_) fclose(f_); }
+
+  size_t read(uint8_t* buf, size_t len) override { return f_ ? fread(buf, 1, len, f_) : 0; }
+  size_t write(const uint8_t* buf, size_t len) override { return f_ ? fwrite(buf, 1, len, f_) : 0; }
+  bool   seek(uint32_t pos) override { return f_ && fseek(f_, (long)pos, SEEK_SET) == 0; }
+  size_t position() override { return f_ ? (size_t)ftell(f_) : 0; }
+  size_t size() override {
+    struct stat st;
+    if (!f_ || fstat(fileno(f_), &st) != 0) return 0;
+    return (uint32_t)st.st_size;
+  }
+  bool isDirectory() override { return dir_; }
+
+private:
+  FILE* f_;
+  bool  dir_;
+};
+}  // namespace
+
+std::string PocketmagePosixFs::full_(const char* path) const {
+  std::string p = path ? path : "";
+  if (p.empty() || p[0] != '/') p.insert(p.begin(), '/');
+  return root_ + p;
+}
+
+std::unique_ptr<PocketmageFsFile> PocketmagePosixFs::open(const char* path, const char* mode) {
+  std::string full = full_(path);
+  struct stat st;
+  if (stat(full.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    // Directories only open for reading, like SD_MMC
+    if (mode[0] != 'r') return nullptr;
+    return std::unique_ptr<PocketmageFsFile>(new PosixFile(nullptr, true));
+  }
+
+  std::string m = std::string(mode) + "b";
+  FILE* f = fopen(full.c_str(), m.c_str());
+  if (!f) return nullptr;
+  return std::unique_ptr<PocketmageFsFile>(new PosixFile(f, false));
+}
+bool PocketmagePosixFs::exists(const char* path) {
+  struct stat st;
+  return stat(full_(path).c_str(), &st) == 0;
+}
+bool PocketmagePosixFs::mkdir(const char* path) { return ::mkdir(full_(path).c_str(), 0777) == 0; }
+bool PocketmagePosixFs::rmdir(const char* path) { return ::rmdir(full_(path).c_str()) == 0; }
+bool PocketmagePosixFs::remove(const char* path) { return ::unlink(full_(path).c_str()) == 0; }
+bool PocketmagePosixFs::rename(const char* from, const char* to) {
+  return ::rename(full_(from).c_str(), full_(to).c_str()) == 0;
+}
+bool PocketmagePosixFs::list(const char* dir, std::vector<Entry>& out) {
+  out.clear();
+  std::string full = full_(dir);
+  DIR* d = opendir(full.c_str());
+  if (!d) return false;
+
+  while (struct dirent* de = readdir(d)) {
+    std::string name = de->d_name;
+    if (name == "." || name == "..") continue;
+
+    struct stat st;
+    if (stat((full + "/" + name).c_str(), &st) != 0) continue;
+    Entry e;
+    e.name  = name;
+    e.isDir = S_ISDIR(st.st_mode);
+    e.size  = e.isDir ? 0 : (uint32_t)st.st_size;
+    e.mtime = st.st_mtime;
+    out.push_back(e);
+  }
+  closedir(d);
+  return true;
+}
+#endif
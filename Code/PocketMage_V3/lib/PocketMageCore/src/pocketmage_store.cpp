@@ -0,0 +1,159 @@
+#include "pocketmage_store.h"
+#include <cstring>
+
+// ===================== helpers =====================
+std::string PocketmageStore::normalize(const char* path) {
+  std::string p = path ? path : "";
+  if (p.empty() || p[0] != '/') p.insert(p.begin(), '/');
+  while (p.size() > 1 && p.back() == '/') p.pop_back();
+  return p;
+}
+size_t PocketmageStore::countVisibleChars(const char* s, size_t len) {
+  size_t count = 0;
+  for (size_t i = 0; i < len; i++) {
+    // ASCII range for printable characters and space
+    if (s[i] >= 32 && s[i] <= 126) count++;
+  }
+  return count;
+}
+
+// ===================== Writer =====================
+void PocketmageStore::Writer::write(const char* p, size_t n) {
+  while (n > 0) {
+    size_t take = (n < CHUNK - used_) ? n : CHUNK - used_;
+    memcpy(buf_ + used_, p, take);
+    used_ += take;
+    p += take;
+    n -= take;
+    if (used_ == CHUNK) flush_();
+  }
+}
+bool PocketmageStore::Writer::flush_() {
+  if (used_ == 0 || !file_) return ok_;
+  if (file_->write(buf_, used_) != used_) ok_ = false;
+  used_ = 0;
+  return ok_;
+}
+bool PocketmageStore::Writer::close() {
+  if (!file_) return false;
+  flush_();
+  file_.reset();
+  return ok_;
+}
+
+// ===================== reading =====================
+bool PocketmageStore::readFile(const char* path, const std::function<void(const char*, size_t)>& sink) {
+  std::unique_ptr<PocketmageFsFile> f = fs_.open(path, "r");
+  if (!f || f->isDirectory()) return false;
+
+  uint8_t buf[512];
+  size_t n;
+  while ((n = f->read(buf, sizeof(buf))) > 0) sink((const char*)buf, n);
+  return true;
+}
+bool PocketmageStore::readFile(const char* path, std::string& out) {
+  out.clear();
+  long size = fileSize(path);
+  if (size > 0) out.reserve((size_t)size);
+  return readFile(path, [&out](const char* p, size_t n) { out.append(p, n); });
+}
+bool PocketmageStore::readBinary(const char* path, uint8_t* buf, size_t len) {
+  std::unique_ptr<PocketmageFsFile> f = fs_.open(path, "r");
+  if (!f || f->isDirectory()) return false;
+  return f->read(buf, len) == len;
+}
+long PocketmageStore::fileSize(const char* path) {
+  std::unique_ptr<PocketmageFsFile> f = fs_.open(path, "r");
+  if (!f || f->isDirectory()) return -1;
+  return (long)f->size();
+}
+
+// ===================== writing =====================
+bool PocketmageStore::writeFile(const char* path, const char* data, size_t len) {
+  std::unique_ptr<PocketmageFsFile> f = fs_.open(path, "w");
+  if (!f) return false;
+  bool ok = f->write((const uint8_t*)data, len) == len;
+  f.reset();
+  notify_(normalize(path));
+  return ok;
+}
+bool PocketmageStore::appendFile(const char* path, const char* data, size_t len) {
+  std::unique_ptr<PocketmageFsFile> f = fs_.open(path, "a");
+  if (!f) return false;
+  bool ok = f->write((const uint8_t*)data, len) == len;
+  f.reset();
+  notify_(normalize(path));
+  return ok;
+}
+bool PocketmageStore::rename(const char* from, const char* to) {
+  if (!fs_.rename(from, to)) return false;
+  notify_(normalize(from));
+  notify_(normalize(to));
+  return true;
+}
+bool PocketmageStore::remove(const char* path) {
+  if (!fs_.remove(path)) return false;
+  notify_(normalize(path));
+  return true;
+}
+
+// ===================== copy =====================
+// Bytes under dir, for progress
+size_t PocketmageStore::treeBytes_(const std::string& dir) {
+  size_t bytes = 0;
+  std::vector<PocketmageFs::Entry> entries;
+  fs_.list(dir.c_str(), entries);
+  for (const PocketmageFs::Entry& e : entries)
+    bytes += e.isDir ? treeBytes_(dir + "/" + e.name) : e.size;
+  return bytes;
+}
+bool PocketmageStore::copyOne_(CopyState& st, const std::string& src, const std::string& dst) {
+  std::unique_ptr<PocketmageFsFile> in = fs_.open(src.c_str(), "r");
+  if (!in || in->isDirectory()) return false;
+  std::unique_ptr<PocketmageFsFile> out = fs_.open(dst.c_str(), "w");
+  if (!out) return false;
+
+  bool ok = true;
+  size_t n;
+  while ((n = in->read(st.buf, st.cap)) > 0) {
+    if (out->write(st.buf, n) != n) {
+      ok = false;
+      break;
+    }
+    st.done += n;
+    if (st.progress) st.progress(st.done, st.total);
+  }
+
+  out.reset();
+  notify_(dst);
+  return ok;
+}
+bool PocketmageStore::copyTree_(CopyState& st, const std::string& src, const std::string& dst) {
+  if (!fs_.exists(dst.c_str()) && !fs_.mkdir(dst.c_str())) return false;
+  notify_(dst);
+
+  std::vector<PocketmageFs::Entry> entries;
+  if (!fs_.list(src.c_str(), entries)) return false;
+  for (const PocketmageFs::Entry& e : entries) {
+    std::string from = src + "/" + e.name;
+    std::string to   = dst + "/" + e.name;
+    if (!(e.isDir ? copyTree_(st, from, to) : copyOne_(st, from, to))) return false;
+  }
+  return true;
+}
+bool PocketmageStore::copy(const char* src, const char* dst, uint8_t* buf, size_t cap, Progress progress) {
+  std::string from = normalize(src);
+  std::string to   = normalize(dst);
+  if (!buf || cap == 0) return false;
+  // Into itself would never finish
+  if (to == from || to.compare(0, from.size() + 1, from + "/") == 0) return false;
+
+  std::unique_ptr<PocketmageFsFile> probe = fs_.open(from.c_str(), "r");
+  if (!probe) return false;
+  bool isDir = probe->isDirectory();
+  CopyState st = {buf, cap, 0, isDir ? 0 : probe->size(), progress};
+  probe.reset();
+  if (isDir) st.total = treeBytes_(from);
+
+  return isDir ? copyTree_(st, from, to) : copyOne_(st, from, to);
+}
@@ -16,6 +16,7 @@
 #define LINES_PER_PAGE      12
 #define LINES_PER_CHUNK    100
 #define MAX_CHUNKS          32
+#define MAX_CHUNK_BYTES  16384
 #define TEXT_POOL_CAP     8192
 #define WORD_REF_CAP       512
 #define MAX_WORD_LEN        64
@@ -164,6 +165,9 @@ static ulong pageIndex    = 0;
 static bool  needsRedraw  = false;
 static bool  fileError    = false;
 
+// The next chunk, read on the storage task while the current one is on screen
+static PocketmageIO::Ticket s_prefetch;
+
 // ── Editor state ──────────────────────────────────────────────────────────────
 static char   s_editorLines[EDITOR_MAX_LINES][EDITOR_LINE_LEN];
 static int    s_editorLineCount = 0;
@@ -214,10 +218,8 @@ static void layoutSegment(const char* seg, int segLen, bool bold,
                           char style, uint16_t textWidth,
                           int& dlWordStart, int& dlWordCount, int& lineWidth,
                           SourceLine& src) {
-  display.setFont(pickFont(style, bold));
-  int16_t  x1, y1;
-  uint16_t sw, sh;
-  display.getTextBounds(SPACEWIDTH_SYMBOL, 0, 0, &x1, &y1, &sw, &sh);
+  const FontMetrics& metrics = EINK().fontMetrics(pickFont(style, bold));
+  uint16_t sw = metrics.textWidth(SPACEWIDTH_SYMBOL);
 
   int wStart = 0;
   while (wStart < segLen) {
@@ -228,8 +230,7 @@ static void layoutSegment(const char* seg, int segLen, bool bold,
       const char* wordText = internWord(seg + wStart, wLen);
       if (!wordText || s_wordRefsUsed >= WORD_REF_CAP) return;
 
-      uint16_t wpx, hpx;
-      display.getTextBounds(wordText, 0, 0, &x1, &y1, &wpx, &hpx);
+      uint16_t wpx = metrics.textWidth(seg + wStart, wLen);
       int addWidth = (int)wpx + (int)sw + WORDWIDTH_BUFFER;
 
       if (lineWidth > 0 && lineWidth + addWidth > (int)textWidth) {
@@ -314,15 +315,13 @@ static void layoutSourceLine(const String& text, char style, ulong orderedListNu
 // ── Chunk loading ─────────────────────────────────────────────────────────────
 static void buildIndex() {
   chunkCount = 0;
+  PM_IO().cancel(s_prefetch);   // Offsets are about to change
+  s_prefetch = nullptr;
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
+  SDSession session;
 
-  File f = SD_MMC.open(s_entryPath, FILE_READ);
-  if (!f) { 
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
+  PocketmageFile f;
+  if (!f.open(s_entryPath, FILE_READ)) { 
     fileError = true; 
     return; 
   }
@@ -358,28 +357,30 @@ static void buildIndex() {
   }
   
   f.close();
-  
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
+}
+
+// The last chunk runs to the end of the file, bounded in case MAX_CHUNKS cut the index short
+static PocketmageIO::Ticket requestChunk(int idx, PocketmageIO::Priority priority) {
+  size_t length = (idx + 1 < chunkCount) ? chunks[idx + 1].offset - chunks[idx].offset : MAX_CHUNK_BYTES;
+  return PM_IO().read(s_entryPath, chunks[idx].offset, length, priority);
 }
 
 static void loadChunk(int idx) {
   if (idx < 0 || idx >= chunkCount) return;
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  File f = SD_MMC.open(s_entryPath, FILE_READ);
-  if (!f) { 
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
-    fileError = true; 
-    return; 
+  // Use the prefetch if it is this chunk, wait() moves it to the front if it hasn't run yet
+  PocketmageIO::Ticket chunk = s_prefetch;
+  if (!chunk || chunk->offset != chunks[idx].offset || chunk->result.path != s_entryPath) {
+    PM_IO().cancel(s_prefetch);
+    chunk = requestChunk(idx, PocketmageIO::URGENT);
   }
+  s_prefetch = nullptr;
 
-  f.seek(chunks[idx].offset);
-  size_t endOffset = (idx + 1 < chunkCount) ? chunks[idx + 1].offset : 0;
+  if (!PM_IO().wait(chunk) || !chunk->result.ok) {
+    fileError = true;
+    return;
+  }
+  const String& text = chunk->result.data;
 
   s_textPoolUsed     = 0;
   s_wordRefsUsed     = 0;
@@ -390,11 +391,14 @@ static void loadChunk(int idx) {
   ulong listCounter = 1;
   int   lineCount   = 0;
 
-  while (f.available()) {
-    if (endOffset != 0 && (size_t)f.position() >= endOffset) break;
+  int pos = 0;
+  while (pos < (int)text.length()) {
     if (lineCount >= LINES_PER_CHUNK) break;
 
-    String raw = f.readStringUntil('\n');
+    int eol = text.indexOf('\n', pos);
+    if (eol < 0) eol = text.length();
+    String raw = text.substring(pos, eol);
+    pos = eol + 1;
     raw.trim();
 
     char   st = 'T';
@@ -431,14 +435,14 @@ static void loadChunk(int idx) {
     layoutSourceLine(content, st, listNum);
     lineCount++;
   }
-  f.close();
-  
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 
   if (s_sourceLinesUsed == 0)
     layoutSourceLine(String("(empty entry)"), 'T', 0);
 
+  // Readers mostly page forward, have the next chunk ready before they get there
+  if (idx + 1 < chunkCount)
+    s_prefetch = requestChunk(idx + 1, PocketmageIO::PREFETCH);
+
   needsRedraw = true;
 }
 
@@ -446,36 +450,25 @@ static void loadChunk(int idx) {
 static void scanManuals() {
   s_manualCount = 0;
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
-  if (!SD_MMC.exists(MANUALS_ROOT)) SD_MMC.mkdir(MANUALS_ROOT);
-
-  File root = SD_MMC.open(MANUALS_ROOT);
-  if (!root || !root.isDirectory()) {
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
+  // Cached listing, the card is only read the first time or after something changed
+  PocketmageDirCache::ListingPtr entries = PM_DIRS().list(MANUALS_ROOT);
+  if (entries->empty()) {
+    SDSession session;
+    if (!SD_MMC.exists(MANUALS_ROOT)) {
+      SD_MMC.mkdir(MANUALS_ROOT);
+      PM_DIRS().invalidate(MANUALS_ROOT);
+    }
     return;
   }
 
-  File f = root.openNextFile();
-  while (f && s_manualCount < MAX_MANUALS) {
-    if (f.isDirectory()) {
-      const char* full  = f.name();
-      const char* slash = strrchr(full, '/');
-      const char* dname = slash ? slash + 1 : full;
-      strncpy(s_manualNames[s_manualCount], dname, MAX_NAME_LEN - 1);
+  for (const PocketmageDirCache::Entry& e : *entries) {
+    if (s_manualCount >= MAX_MANUALS) break;
+    if (e.isDir) {
+      strncpy(s_manualNames[s_manualCount], e.name.c_str(), MAX_NAME_LEN - 1);
       s_manualNames[s_manualCount][MAX_NAME_LEN - 1] = '\0';
       s_manualCount++;
     }
-    f.close();
-    f = root.openNextFile();
   }
-  root.close();
-
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 
   // Sort alphabetically
   for (int i = 0; i < s_manualCount - 1; i++) {
@@ -492,11 +485,14 @@ static void scanManuals() {
 
 // ── Entry scanning ────────────────────────────────────────────────────────────
 static void scanEntries() {
+  // Same manual and nothing on the card changed since the last scan, the arrays are current
+  static String   scannedDir = "";
+  static uint32_t scannedGeneration = 0;
+  if (scannedDir == s_entriesDir && scannedGeneration == PM_DIRS().generation()) return;
+
   s_entryCount = 0;
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
+  SDSession session;
 
   // Create directories if they don't exist
   if (!SD_MMC.exists(s_entriesDir)) {
@@ -506,22 +502,19 @@ static void scanEntries() {
     if (!SD_MMC.exists(MANUALS_ROOT)) SD_MMC.mkdir(MANUALS_ROOT);
     if (!SD_MMC.exists(manualDir)) SD_MMC.mkdir(manualDir);
     SD_MMC.mkdir(s_entriesDir);
+    PM_DIRS().invalidate(MANUALS_ROOT);
+    PM_DIRS().invalidate(manualDir);
   }
-  if (!SD_MMC.exists(s_imagesDir)) SD_MMC.mkdir(s_imagesDir);
-
-  File dir = SD_MMC.open(s_entriesDir);
-  if (!dir || !dir.isDirectory()) {
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
-    return;
+  if (!SD_MMC.exists(s_imagesDir)) {
+    SD_MMC.mkdir(s_imagesDir);
+    PM_DIRS().invalidate(s_imagesDir);
   }
 
-  File entry = dir.openNextFile();
-  while (entry && s_entryCount < MAX_ENTRIES) {
-    if (!entry.isDirectory()) {
-      const char* full  = entry.name();
-      const char* slash = strrchr(full, '/');
-      const char* fname = slash ? slash + 1 : full;
+  PocketmageDirCache::ListingPtr entries = PM_DIRS().list(s_entriesDir);
+  for (const PocketmageDirCache::Entry& entry : *entries) {
+    if (s_entryCount >= MAX_ENTRIES) break;
+    if (!entry.isDir) {
+      const char* fname = entry.name.c_str();
       int flen = (int)strlen(fname);
       if (flen > 3 && strcmp(fname + flen - 3, ".md") == 0) {
         int idx = s_entryCount;
@@ -532,8 +525,8 @@ static void scanEntries() {
         // Peek at first 20 lines to extract **Tags:** value
         char entryPath[160];
         snprintf(entryPath, sizeof(entryPath), "%s/%s", s_entriesDir, fname);
-        File peek = SD_MMC.open(entryPath, FILE_READ);
-        if (peek) {
+        PocketmageFile peek(512);
+        if (peek.open(entryPath, FILE_READ)) {
           for (int ln = 0; ln < 20 && peek.available(); ln++) {
             String line = peek.readStringUntil('\n');
             line.trim();
@@ -556,13 +549,9 @@ static void scanEntries() {
         s_entryCount++;
       }
     }
-    entry.close();
-    entry = dir.openNextFile();
   }
-  dir.close();
-
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
+  scannedDir = s_entriesDir;
+  scannedGeneration = PM_DIRS().generation();
 
   // Sort entries alphabetically, keeping tags in sync
   for (int i = 0; i < s_entryCount - 1; i++) {
@@ -627,12 +616,10 @@ static void editorInit(const char* fname) {
     char path[128];
     snprintf(path, sizeof(path), "%s/%s", s_entriesDir, fname);
 
-    SDActive = true;
-    pocketmage::setCpuSpeed(240);
-    delay(50);
+    SDSession session;
 
-    File f = SD_MMC.open(path, FILE_READ);
-    if (f) {
+    PocketmageFile f;
+    if (f.open(path, FILE_READ)) {
       while (f.available() && s_editorLineCount < EDITOR_MAX_LINES) {
         String line = f.readStringUntil('\n');
         line.trim();
@@ -641,10 +628,6 @@ static void editorInit(const char* fname) {
       }
       f.close();
     }
-    
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
-    
   } else {
     s_editorFilename[0] = '\0';
     // Start with a template
@@ -685,22 +668,18 @@ static void editorSave() {
   char path[128];
   snprintf(path, sizeof(path), "%s/%s", s_entriesDir, s_editorFilename);
   
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
+  SDSession session;
 
-  File f = SD_MMC.open(path, FILE_WRITE);
-  if (f) {
+  PocketmageFile f;
+  if (f.open(path, FILE_WRITE)) {
     for (int i = 0; i < s_editorLineCount; i++) {
       f.print(s_editorLines[i]);
       f.print('\n');
     }
     f.close();
+    PM_DIRS().invalidate(path);
   }
-  
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
-  
+
   s_editorDirty = false;
 }
 
@@ -828,21 +807,18 @@ static int renderSourceLine(int si, int startX, int startY) {
 
     for (int wi = dl.wordStart; wi < dl.wordStart + dl.wordCount; wi++) {
       const WordRef& w = s_wordRefs[wi];
-      display.setFont(pickFont(style, w.bold));
-      int16_t  x1, y1;
-      uint16_t wpx, hpx;
-      display.getTextBounds(w.text, cx, cursorY, &x1, &y1, &wpx, &hpx);
+      uint16_t hpx = EINK().fontMetrics(pickFont(style, w.bold)).textHeight(w.text);
       if (hpx > max_hpx) max_hpx = hpx;
     }
     if (style == '1' || style == '2' || style == '3') max_hpx += 4;
 
     for (int wi = dl.wordStart; wi < dl.wordStart + dl.wordCount; wi++) {
       const WordRef& w = s_wordRefs[wi];
-      display.setFont(pickFont(style, w.bold));
-      int16_t  x1, y1;
-      uint16_t wpx, hpx, sw, sh;
-      display.getTextBounds(w.text, cx, cursorY, &x1, &y1, &wpx, &hpx);
-      display.getTextBounds(SPACEWIDTH_SYMBOL, cx, cursorY, &x1, &y1, &sw, &sh);
+      const GFXfont* font = pickFont(style, w.bold);
+      const FontMetrics& metrics = EINK().fontMetrics(font);
+      display.setFont(font);
+      uint16_t wpx = metrics.textWidth(w.text);
+      uint16_t sw  = metrics.textWidth(SPACEWIDTH_SYMBOL);
       display.setCursor(cx, cursorY + max_hpx);
       display.print(w.text);
       cx += (int)wpx + (int)sw;
@@ -867,10 +843,10 @@ static int renderSourceLine(int si, int startX, int startY) {
   } else if (style == 'L') {
     char num[16];
     snprintf(num, sizeof(num), "%lu. ", src.orderedListNum);
-    display.setFont(pickFont('T', false));
-    int16_t  x1, y1;
-    uint16_t wpx, hpx;
-    display.getTextBounds(num, 0, 0, &x1, &y1, &wpx, &hpx);
+    const FontMetrics& metrics = EINK().fontMetrics(pickFont('T', false));
+    display.setFont(metrics.font);
+    uint16_t wpx = metrics.textWidth(num);
+    uint16_t hpx = metrics.textHeight(num);
     display.setCursor(drawX - (int)wpx - 5, startY + (int)hpx);
     display.print(num);
   }
@@ -17,7 +17,7 @@ AppLoaderState CurrentAppLoaderState = MENU;
 uint8_t selectedSlot = 0; //1:A, 2:B, etc.
 
 // ---------- Globals ----------
-volatile uint8_t g_installProgress = 0; // 0-100 (0-50: extract, 50-100: intall)
+volatile uint8_t g_installProgress = 0; // 0-100 (0-50: extract, 50-60: assets, 60-100: flash)
 volatile bool g_installDone = false;
 volatile bool g_installFailed = false;
 
@@ -45,87 +45,6 @@ static bool rmRF(fs::FS &fs, const char *path) {
     return fs.rmdir(path);
 }
 
-bool copyFile(fs::FS &fs, const char *src, const char *dst) {
-  File in = fs.open(src, "r");
-  if (!in) return false;
-
-  File out = fs.open(dst, "w");
-  if (!out) { in.close(); return false; }
-
-  uint8_t buf[1024];
-  while (in.available()) {
-    size_t r = in.read(buf, sizeof(buf));
-    if (out.write(buf, r) != r) {
-      in.close(); out.close();
-      return false;
-    }
-    vTaskDelay(1); // feed watchdog
-  }
-
-  in.close();
-  out.close();
-  return true;
-}
-// ---------- Place this at the top of the .cpp file, before installTask ----------
-void copyDirRecursive(File src, const String &assetsSrc, const String &assetsDst) {
-    while (true) {
-        File entry = src.openNextFile();
-        if (!entry) break;
-
-        String name = entry.name();
-        String relative = name.substring(assetsSrc.length());
-        String dstFile = assetsDst + relative;
-
-        if (entry.isDirectory()) {
-            ensureDir(*global_fs, dstFile.c_str());
-            copyDirRecursive(entry, assetsSrc, assetsDst);
-        } else {
-            File dst = global_fs->open(dstFile.c_str(), FILE_WRITE);
-            if (dst) {
-                uint8_t buf[512];
-                size_t len;
-                while ((len = entry.read(buf, sizeof(buf))) > 0) {
-                    dst.write(buf, len);
-                }
-                dst.close();
-                Serial.printf("Copied %s -> %s\n", name.c_str(), dstFile.c_str());
-            } else {
-                Serial.printf("Failed to open destination file %s\n", dstFile.c_str());
-            }
-        }
-        entry.close();
-    }
-}
-
-bool copyAssetsFlat(fs::FS &fs, const char *srcDir, const char *dstDir) {
-  ensureDir(fs, dstDir);
-
-  File dir = fs.open(srcDir);
-  if (!dir || !dir.isDirectory()) return false;
-
-  File f;
-  while ((f = dir.openNextFile())) {
-    String srcPath = String(srcDir) + "/" + f.name();
-    String dstPath = String(dstDir) + "/" + f.name();
-
-    if (f.isDirectory()) {
-      ensureDir(fs, dstPath.c_str());
-      copyAssetsFlat(fs, srcPath.c_str(), dstPath.c_str());
-    } else {
-      if (!copyFile(fs, srcPath.c_str(), dstPath.c_str())) {
-        f.close();
-        dir.close();
-        return false;
-      }
-    }
-    f.close();
-    vTaskDelay(1);
-  }
-  dir.close();
-  return true;
-}
-
-
 static String basenameNoExt(const String &path, const char *ext = ".tar") {
   int slash = path.lastIndexOf('/');
   String name = (slash >= 0) ? path.substring(slash + 1) : path;
@@ -262,25 +181,15 @@ struct InstallTaskParams {
     int otaIndex; // 1..4
 };
 
-static void installTask(void *param) {
-	pocketmage::setCpuSpeed(240);
-
-	InstallTaskParams *p = (InstallTaskParams *)param;
-	g_installProgress = 0;
-	g_installDone = false;
-	g_installFailed = false;
-
+// Every step of the install, false as soon as one fails. Runs inside installTask's SDSession.
+static bool runInstall(InstallTaskParams *p) {
 	//String tarPath = String(APP_DIRECTORY) + "/" + p->tarRelName;
   String tarPath = pathJoin(APP_DIRECTORY, p->tarRelName);
 
 	// --- Check TAR exists ---
 	if (!global_fs->exists(tarPath.c_str())) {
 		Serial.printf("Tar not found: %s\n", tarPath.c_str());
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-		g_installFailed = true;
-		g_installDone = true;
-		delete p;
-		vTaskDelete(NULL);
+		return false;
 	}
 
 	// --- Ensure directories ---
@@ -288,11 +197,7 @@ static void installTask(void *param) {
 		//!rmRF(*global_fs, TEMP_DIR) ||
 		!ensureDir(*global_fs, TEMP_DIR)) {
 		Serial.println("Failed to prepare TEMP_DIR");
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-		g_installFailed = true;
-		g_installDone = true;
-		delete p;
-		vTaskDelete(NULL);
+		return false;
 	}
 
 	// --- TAR extraction ---
@@ -304,13 +209,7 @@ static void installTask(void *param) {
 
 	if (!unpacker.tarExpander(*global_fs, tarPath.c_str(), *global_fs, TEMP_DIR)) {
 		Serial.printf("Extraction failed (err=%d)\n", unpacker.tarGzGetError());
-
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-		g_installFailed = true;
-		g_installDone = true;
-		delete p;
-		vTaskDelete(NULL);
+		return false;
 	}
 
 	g_installProgress = 50; // halfway
@@ -357,10 +256,7 @@ if (tempRoot && tempRoot.isDirectory()) {
 
 if (binPath.length() == 0 || base.length() == 0) {
     Serial.printf("Bin not found after extraction in %s\n", TEMP_DIR);
-    g_installFailed = true;
-    g_installDone = true;
-    delete p;
-    vTaskDelete(NULL);
+    return false;
 }
 
 Serial.printf("App base name determined: '%s'\n", base.c_str());
@@ -404,11 +300,7 @@ if (tempRoot && tempRoot.isDirectory()) {
 if (binPath.length() == 0 || !global_fs->exists(binPath.c_str())) {
     Serial.printf("Bin not found after extraction: %s\n", binPath.c_str());
     cleanupAppsTempRecursive(*global_fs, TEMP_DIR);
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    g_installFailed = true;
-    g_installDone = true;
-    delete p;
-    vTaskDelete(NULL);
+    return false;
 }
 
 delay(100);
@@ -419,15 +311,17 @@ String assetsDst = pathJoin("/assets", base);   // <-- correct target path
 
 if (global_fs->exists(assetsSrc.c_str())) {
     rmRF(*global_fs, assetsDst.c_str()); // clean old assets
+    // Extraction and rmRF went around the directory cache
+    PM_DIRS().invalidate(TEMP_DIR);
+    PM_DIRS().invalidate(assetsDst);
     Serial.printf("Copying assets: %s -> %s\n", assetsSrc.c_str(), assetsDst.c_str());
-    if (!copyAssetsFlat(*global_fs, assetsSrc.c_str(), assetsDst.c_str())) {
+    bool copied = PM_SDAUTO().copyPath(assetsSrc, assetsDst, [](size_t done, size_t total) {
+        g_installProgress = 50 + (total ? done * 10 / total : 10); // 50–60% assets
+    });
+    if (!copied) {
         Serial.println("Failed to copy assets!");
-        g_installFailed = true;
-        g_installDone = true;
         cleanupAppsTempRecursive(*global_fs, TEMP_DIR);
-            if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-        delete p;
-        vTaskDelete(NULL);
+        return false;
     }
 }
 
@@ -442,12 +336,7 @@ if (global_fs->exists(assetsSrc.c_str())) {
 		Serial.printf("OTA_%d partition not found\n", p->otaIndex);
 
     cleanupAppsTempRecursive(*global_fs, TEMP_DIR);
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-		g_installFailed = true;
-		g_installDone = true;
-		delete p;
-		vTaskDelete(NULL);
+    return false;
 	}
 
 	File f = global_fs->open(binPath, "r");
@@ -455,12 +344,7 @@ if (global_fs->exists(assetsSrc.c_str())) {
 		Serial.printf("Failed to open: %s\n", binPath.c_str());
 
     cleanupAppsTempRecursive(*global_fs, TEMP_DIR);
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-		g_installFailed = true;
-		g_installDone = true;
-		delete p;
-		vTaskDelete(NULL);
+    return false;
 	}
 
 	uint32_t sz = f.size();
@@ -474,12 +358,7 @@ if (global_fs->exists(assetsSrc.c_str())) {
 		f.close();
     
     cleanupAppsTempRecursive(*global_fs, TEMP_DIR);
-    if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-		g_installFailed = true;
-		g_installDone = true;
-		delete p;
-		vTaskDelete(NULL);
+    return false;
 	}
 
 	uint8_t buf[4096];
@@ -493,22 +372,17 @@ if (global_fs->exists(assetsSrc.c_str())) {
 			f.close();
 
       cleanupAppsTempRecursive(*global_fs, TEMP_DIR);
-        if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
-			g_installFailed = true;
-			g_installDone = true;
-			delete p;
-			vTaskDelete(NULL);
+      return false;
 		}
 		written += rd;
-		g_installProgress = 50 + (written * 50 / sz); // 50–100% flashing
+		g_installProgress = 60 + (written * 40 / sz); // 60–100% flashing
 	}
 
 	f.close();
 	err = esp_ota_end(ota_handle);
-	if (err != ESP_OK) {
+	bool ok = err == ESP_OK;
+	if (!ok) {
 		Serial.printf("esp_ota_end failed: %s\n", esp_err_to_name(err));
-		g_installFailed = true;
 	} else {
 		Serial.println("Flash OK");
 
@@ -533,12 +407,26 @@ if (iconPath.length() == 0) {
 	}
 
   cleanupAppsTempRecursive(*global_fs, TEMP_DIR);
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
 
 	g_installProgress = 100;
-	g_installDone = true;
+	return ok;
+}
 
+static void installTask(void *param) {
+	InstallTaskParams *p = (InstallTaskParams *)param;
+	g_installProgress = 0;
+	g_installDone = false;
+	g_installFailed = false;
+
+	{
+		// One session for the whole install: global_fs stays with this task and the CPU at 240 MHz
+		SDSession session;
+		if (!runInstall(p)) g_installFailed = true;
+	}
+
+	g_installDone = true;
 	delete p;
+	// Nothing on this stack may still need destructing, vTaskDelete doesn't return
 	vTaskDelete(NULL);
 }
 
@@ -817,6 +705,8 @@ void processKB_APPLOADER() {
       if (!g_installDone) {
         drawProgressBar(g_installProgress);
       } else {
+        // The install rewrote /apps and the assets, drop every cached listing
+        PM_DIRS().clear();
         delay(500);
         if (g_installFailed) {
           OLED().oledWord("Install failed!");
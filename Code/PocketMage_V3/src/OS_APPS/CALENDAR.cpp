@@ -42,13 +42,11 @@ void CALENDAR_INIT() {
 // 
 #pragma message "TODO: Migrate to a better/global file management system"
 void updateEventArray() {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
+  SDSession session;
 
-  File file = global_fs->open("/sys/events.txt", "r"); // Open the text file in read mode
-  if (!file) {
-    ESP_LOGE(TAG, "Failed to open file for reading: %s", file.path());
+  PocketmageFile file;
+  if (!file.open("/sys/events.txt", "r")) { // Open the text file in read mode
+    ESP_LOGE(TAG, "Failed to open file for reading: %s", "/sys/events.txt");
     return;
   }
 
@@ -83,9 +81,6 @@ void updateEventArray() {
   }
 
   file.close();  // Close the file
-
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 void sortEventsByDate(std::vector<std::vector<String>> &calendarEvents) {
@@ -95,23 +90,15 @@ void sortEventsByDate(std::vector<std::vector<String>> &calendarEvents) {
 }
 
 void updateEventsFile() {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-  // Clear the existing calendarEvents file first
-  PM_SDAUTO().delFile("/sys/events.txt");
-
-  // Iterate through the calendarEvents vector and append each task to the file
+  // Build one line per event with "|" delimiters
+  std::vector<String> lines;
+  lines.reserve(calendarEvents.size());
   for (size_t i = 0; i < calendarEvents.size(); i++) {
-    // Create a string from the task's attributes with "|" delimiter
-    String eventInfo = calendarEvents[i][0] + "|" + calendarEvents[i][1] + "|" + calendarEvents[i][2] + "|" + calendarEvents[i][3]+ "|" + calendarEvents[i][4]+ "|" + calendarEvents[i][5];
-    
-    // Append the task info to the file
-    PM_SDAUTO().appendToFile("/sys/events.txt", eventInfo);
+    lines.push_back(calendarEvents[i][0] + "|" + calendarEvents[i][1] + "|" + calendarEvents[i][2] + "|" + calendarEvents[i][3]+ "|" + calendarEvents[i][4]+ "|" + calendarEvents[i][5]);
   }
 
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
+  // Replace the events file in one write
+  PM_SDAUTO().writeLines("/sys/events.txt", lines);
 }
 
 void addEvent(String eventName, String startDate, String startTime , String duration, String repeat, String note) {
@@ -14,7 +14,6 @@ FileWizState CurrentFileWizState = WIZ0_;
 
 String currentWord = "";
 static String currentLine = "";
-bool refreshFiles = false;
 
 std::vector<String> excludedPaths = {
   "/sys",
@@ -76,45 +75,38 @@ String renderWizMini(String folder, int8_t scrollDelta) {
   static long scroll = 0;
   static String prevFolder = "";
   static std::vector<FileObject> cachedFiles;
+  static uint32_t prevGeneration = 0;
 
-  // Reload directory if folder changed
-  if (folder != prevFolder) {
-    SDActive = true;
-    pocketmage::setCpuSpeed(240);
-
-    scroll = 0;
-    scrollDelta = 0;
+  // Reload directory if folder changed, or if the SD layer changed any cached listing
+  if (folder != prevFolder || PM_DIRS().generation() != prevGeneration) {
+    if (folder != prevFolder) {
+      scroll = 0;
+      scrollDelta = 0;
+    }
     cachedFiles.clear();
 
-    File dir = global_fs->open(folder);
-    if (dir && dir.isDirectory()) {
-      File entry;
-      while ((entry = dir.openNextFile())) {
-        // Normalize full path
-        String fullPath = folder;
-        if (!fullPath.endsWith("/")) fullPath += "/";
-        fullPath += entry.name();
-
-        // Skip folder itself if in excludedPaths
-        bool skip = false;
-        for (auto &ex : excludedPaths) {
-          if (fullPath.equalsIgnoreCase(ex)) {
-            skip = true;
-            break;
-          }
-        }
-        if (skip) {
-          entry.close();
-          continue;
-        }
+    String base = folder;
+    if (!base.endsWith("/")) base += "/";
+
+    PocketmageDirCache::ListingPtr entries = PM_DIRS().list(folder);
+    for (const PocketmageDirCache::Entry& entry : *entries) {
+      // Normalize full path
+      String fullPath = base + entry.name;
 
-        FileObject f;
-        f.init(fullPath, entry.isDirectory());
-        cachedFiles.push_back(f);
-        entry.close();
+      // Skip folder itself if in excludedPaths
+      bool skip = false;
+      for (auto &ex : excludedPaths) {
+        if (fullPath.equalsIgnoreCase(ex)) {
+          skip = true;
+          break;
+        }
       }
+      if (skip) continue;
+
+      FileObject f;
+      f.init(fullPath, entry.isDir);
+      cachedFiles.push_back(f);
     }
-    dir.close();
 
     // Sort: folders first (alphabetical), then files (alphabetical)
     std::sort(cachedFiles.begin(), cachedFiles.end(), [](const FileObject &a, const FileObject &b) {
@@ -124,26 +116,9 @@ String renderWizMini(String folder, int8_t scrollDelta) {
     });
 
     prevFolder = folder;
-
-    if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
+    prevGeneration = PM_DIRS().generation();
   }
 
-  #pragma message "TODO: Need to refresh directory here."
-  // Reload directory if file changed
-  /*if (refreshFiles) {
-    SDActive = true;
-    pocketmage::setCpuSpeed(240);
-    delay(50);
-
-    // reload here
-
-    if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    SDActive = false;
-  }*/
-
   // Empty folder
   if (cachedFiles.empty()) {
     String msg = folder + " is empty!";
@@ -422,7 +397,6 @@ void processKB_FILEWIZ() {
           PM_SDAUTO().delFile(PM_SDAUTO().getWorkingFile());
           
           // RETURN TO FILE WIZ HOME
-          refreshFiles = true;
           CurrentFileWizState = WIZ0_;
           newState = true;
           break;
@@ -501,7 +475,6 @@ void processKB_FILEWIZ() {
           PM_SDAUTO().renFile(PM_SDAUTO().getWorkingFile(), newName);
 
           // RETURN TO WIZ0
-          refreshFiles = true;
           CurrentFileWizState = WIZ0_;
           KB().setKeyboardState(NORMAL);
           newState = true;
@@ -583,7 +556,6 @@ void processKB_FILEWIZ() {
           PM_SDAUTO().copyFile(PM_SDAUTO().getWorkingFile(), newName);
 
           // RETURN TO WIZ0
-          refreshFiles = true;
           CurrentFileWizState = WIZ0_;
           KB().setKeyboardState(NORMAL);
           newState = true;
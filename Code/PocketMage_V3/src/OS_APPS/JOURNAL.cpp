@@ -38,9 +38,7 @@ bool isLeapYear(int year) {
 }
 
 void drawJMENU() {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
+  SDSession session;
 
   // Display background
   EINK().drawStatusBar("Type:YYYYMMDD or (T)oday");
@@ -137,15 +135,10 @@ void drawJMENU() {
     String fileCode = "/journal/" + year + "12" + dayCode + ".txt";
     if (global_fs->exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 149, 4, 4, GxEPD_BLACK);
   }
-
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 void JMENUCommand(String command) {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
+  SDSession session;
 
   command.toLowerCase();
 
@@ -166,12 +159,11 @@ void JMENUCommand(String command) {
     if (!global_fs->exists(fileName)) {
       File f = global_fs->open(fileName, FILE_WRITE);
       if (f) f.close();
+      PM_DIRS().invalidate(fileName);
     }
 
     currentJournal = fileName;
 
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
     // Load file
     TXT_INIT_JournalMode();
     
@@ -185,12 +177,11 @@ void JMENUCommand(String command) {
     if (!global_fs->exists(fileName)) {
       File f = global_fs->open(fileName, FILE_WRITE);
       if (f) f.close();
+      PM_DIRS().invalidate(fileName);
     }
 
     currentJournal = fileName;
 
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
     // Load file
     TXT_INIT_JournalMode();
     
@@ -206,15 +197,11 @@ void JMENUCommand(String command) {
       int day = dayStr.toInt();
 
       if (day < 1 || day > 31) {
-        if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-        SDActive = false;
         return;  // invalid day
       }
       String monthMap = "janfebmaraprmayjunjulaugsepoctnovdec";
       int monthIndex = monthMap.indexOf(monthStr);
       if (monthIndex == -1) {
-        if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-        SDActive = false;
         return;  // invalid month
       }
       int month = (monthIndex / 3) + 1;
@@ -227,21 +214,17 @@ void JMENUCommand(String command) {
       if (!global_fs->exists(fileName)) {
         File f = global_fs->open(fileName, FILE_WRITE);
         if (f) f.close();
+        PM_DIRS().invalidate(fileName);
       }
 
       currentJournal = fileName;
 
-      if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-      SDActive = false;
       // Load file
       TXT_INIT_JournalMode();
       
       return;
     }
   }
-
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 // Loops
@@ -77,21 +77,20 @@ void LEXICON_INIT() {
   definitionIndex = 0;
 
   // Verify that dict is installed
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-  if (!global_fs->exists("/dict/A.txt")) {
+  bool dictInstalled;
+  {
+    SDSession session;
+    dictInstalled = global_fs->exists("/dict/A.txt");
+  }
+  if (!dictInstalled) {
     OLED().oledWord("Please install dict from GitHub!");
     delay(5000);
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     HOME_INIT();
   }
 }
 
 void loadDefinitions(String input) {
   OLED().oledWord("Loading Definitions");
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
 
   defList.clear();  // Clear previous results
 
@@ -100,61 +99,60 @@ void loadDefinitions(String input) {
   String word = query.word;
 
   if (word.length() == 0 || PM_SDAUTO().getNoSD()) {
-    SDActive = false;
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     return;
   }
 
   char firstChar = tolower(word[0]);
   if (firstChar < 'a' || firstChar > 'z') {
-    SDActive = false;
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     return;
   }
 
   String filePath = "/dict/" + String((char)toupper(firstChar)) + ".txt";
 
-  File file = global_fs->open(filePath);
-  if (!file) {
-    OLED().oledWord("Missing Dictionary!");
-    delay(2000);
-    SDActive = false;
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-    return;
-  }
-
-  word.toLowerCase();
-
-  while (file.available()) {
-    String line = file.readStringUntil('\n');
-    line.trim();
-    if (line.length() == 0)
-      continue;
-
-    int defSplit = line.indexOf(')');
-    if (defSplit == -1)
-      continue;
-
-    // Extract key and definition
-    String key = line.substring(0, defSplit + 1);
-    String def = line.substring(defSplit + 1);
-    def.trim();
-
-    String keyLower = key;
-    keyLower.toLowerCase();
+  bool opened;
+  {
+    SDSession session;
+
+    PocketmageFile file;
+    opened = file.open(filePath);
+    if (opened) {
+      word.toLowerCase();
+
+      while (file.available()) {
+        String line = file.readStringUntil('\n');
+        line.trim();
+        if (line.length() == 0)
+          continue;
+
+        int defSplit = line.indexOf(')');
+        if (defSplit == -1)
+          continue;
+
+        // Extract key and definition
+        String key = line.substring(0, defSplit + 1);
+        String def = line.substring(defSplit + 1);
+        def.trim();
+
+        String keyLower = key;
+        keyLower.toLowerCase();
+
+        if (keyLower.startsWith(word)) {
+          defList.push_back({key, def});
+        } else if (!defList.empty()) {
+          // No more definitions for this word
+          break;
+        }
+      }
 
-    if (keyLower.startsWith(word)) {
-      defList.push_back({key, def});
-    } else if (!defList.empty()) {
-      // No more definitions for this word
-      break;
+      file.close();
     }
   }
 
-  file.close();
+  if (!opened) {
+    OLED().oledWord("Missing Dictionary!");
+    delay(2000);
+    return;
+  }
 
   if (defList.empty()) {
     OLED().oledWord("No definitions found");
@@ -172,10 +170,6 @@ void loadDefinitions(String input) {
 
     newState = true;
   }
-
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 void processKB_LEXICON() {
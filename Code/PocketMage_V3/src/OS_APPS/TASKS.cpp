@@ -37,28 +37,15 @@ void sortTasksByDueDate(std::vector<std::vector<String>> &tasks) {
 }
 
 void updateTasksFile() {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-  // Clear the existing tasks file first
-  PM_SDAUTO().delFile("/sys/tasks.txt");
-
-  pocketmage::setCpuSpeed(240);
-  if (!global_fs->exists("/sys/tasks.txt")) {
-    File f = global_fs->open("/sys/tasks.txt", FILE_WRITE);
-    if (f) f.close();
-  }
-  // Iterate through the tasks vector and append each task to the file
+  // Build one line per task with "|" delimiters
+  std::vector<String> lines;
+  lines.reserve(tasks.size());
   for (size_t i = 0; i < tasks.size(); i++) {
-    // Create a string from the task's attributes with "|" delimiter
-    String taskInfo = tasks[i][0] + "|" + tasks[i][1] + "|" + tasks[i][2] + "|" + tasks[i][3];
-    
-    // Append the task info to the file
-    PM_SDAUTO().appendToFile("/sys/tasks.txt", taskInfo);
+    lines.push_back(tasks[i][0] + "|" + tasks[i][1] + "|" + tasks[i][2] + "|" + tasks[i][3]);
   }
 
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
+  // Replace the tasks file in one write
+  PM_SDAUTO().writeLines("/sys/tasks.txt", lines);
 }
 
 void addTask(String taskName, String dueDate, String priority, String completed) {
@@ -70,12 +57,10 @@ void addTask(String taskName, String dueDate, String priority, String completed)
 }
 
 void updateTaskArray() {
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-  File file = global_fs->open("/sys/tasks.txt", "r"); // Open the text file in read mode
-  if (!file) {
-    ESP_LOGE(TAG, "Failed to open file to read: %s", file.path());
+  SDSession session;
+  PocketmageFile file;
+  if (!file.open("/sys/tasks.txt", "r")) { // Open the text file in read mode
+    ESP_LOGE(TAG, "Failed to open file to read: %s", "/sys/tasks.txt");
     return;
   }
 
@@ -107,9 +92,6 @@ void updateTaskArray() {
   }
 
   file.close();  // Close the file
-
-  if (SAVE_POWER) pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 
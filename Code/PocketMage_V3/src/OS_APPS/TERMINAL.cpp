@@ -84,10 +84,10 @@ void potionScrollPreview() {
 
 void loadPotionFile(String path) {
   potionLines.clear();
-  pocketmage::setCpuSpeed(240);
+  SDSession session;
 
-  File file = global_fs->open(path);
-  if (!file || file.isDirectory()) {
+  PocketmageFile file;
+  if (!file.open(path) || file.isDirectory()) {
     return;
   }
 
@@ -120,27 +120,27 @@ void loadPotionFile(String path) {
   // If document is blank, open a line
   if (potionLines.size() == 0)
     potionLines.push_back("");
-
-  pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
 }
 
 void savePotionFile(String path) {
-  pocketmage::setCpuSpeed(240);
+  {
+    SDSession session;
 
-  File file = global_fs->open(path, FILE_WRITE);
-  if (!file) {
-    return;
-  }
+    PocketmageFile file;
+    if (!file.open(path, FILE_WRITE)) {
+      return;
+    }
 
-  for (size_t i = 0; i < potionLines.size(); i++) {
-    file.print(potionLines[i]);
-    if (i < potionLines.size() - 1) {
-      file.print('\n');
+    for (size_t i = 0; i < potionLines.size(); i++) {
+      file.print(potionLines[i]);
+      if (i < potionLines.size() - 1) {
+        file.print('\n');
+      }
     }
-  }
 
-  file.close();
-  pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+    file.close();
+    PM_DIRS().invalidate(path);
+  }
   OLED().oledWord("FILE SAVED");
   delay(500);
 }
@@ -222,6 +222,7 @@ void funcSelect(String command) {
     terminalOutputs.push_back("txt <file>       Open in TXT");
     terminalOutputs.push_back("potion/pot <file>  Edit prgm");
     terminalOutputs.push_back("brew <file>         Run prgm");
+    terminalOutputs.push_back("sdbench     SD buffer speed");
 
     newState = true;
     return;
@@ -229,40 +230,42 @@ void funcSelect(String command) {
 
   // Enter directory
   else if (command.startsWith("cd")) {
-    pocketmage::setCpuSpeed(240);
-    // Remove "cd " prefix and trim whitespace
-    String arg = command.substring(2);
-    arg.trim();
-    if (arg.length() == 0) {
-      currentDir = "/";  // 'cd' alone returns to root
-    } else {
-      String newPath = arg;
-      // Handle relative paths
-      if (!newPath.startsWith("/")) {
-        if (!currentDir.endsWith("/"))
-          currentDir += "/";
-        newPath = currentDir + newPath;
-      }
-      // Remove trailing '/' unless root
-      if (newPath.length() > 1 && newPath.endsWith("/")) {
-        newPath.remove(newPath.length() - 1);
-      }
+    {
+      SDSession session;
+
+      // Remove "cd " prefix and trim whitespace
+      String arg = command.substring(2);
+      arg.trim();
+      if (arg.length() == 0) {
+        currentDir = "/";  // 'cd' alone returns to root
+      } else {
+        String newPath = arg;
+        // Handle relative paths
+        if (!newPath.startsWith("/")) {
+          if (!currentDir.endsWith("/"))
+            currentDir += "/";
+          newPath = currentDir + newPath;
+        }
+        // Remove trailing '/' unless root
+        if (newPath.length() > 1 && newPath.endsWith("/")) {
+          newPath.remove(newPath.length() - 1);
+        }
 
-      // Check if directory exists
-      if (global_fs->exists(newPath)) {
-        File f = global_fs->open(newPath);
-        if (f && f.isDirectory()) {
-          currentDir = newPath;
+        // Check if directory exists
+        if (global_fs->exists(newPath)) {
+          File f = global_fs->open(newPath);
+          if (f && f.isDirectory()) {
+            currentDir = newPath;
+          } else {
+            returnText = "cd: Not a directory";
+          }
+          f.close();
         } else {
-          returnText = "cd: Not a directory";
+          returnText = "cd: No such directory";
         }
-        f.close();
-      } else {
-        returnText = "cd: No such directory";
       }
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -274,7 +277,6 @@ void funcSelect(String command) {
 
   // List directory
   else if (command.startsWith("ls")) {
-    pocketmage::setCpuSpeed(240);
     String arg = command.substring(2);
     arg.trim();
     String listPath = currentDir;
@@ -288,36 +290,33 @@ void funcSelect(String command) {
       }
     }
 
-    if (global_fs->exists(listPath)) {
-      File dir = global_fs->open(listPath);
-      if (dir && dir.isDirectory()) {
-        File file = dir.openNextFile();
-        while (file) {
-          String lineOutput = "";
-          if (file.isDirectory())
-            lineOutput += "[DIR]";
-          else
-            lineOutput += "     ";
-          lineOutput += file.name();
-          if (!file.isDirectory()) {
-            lineOutput += " * ";
-            lineOutput += String(file.size()) + "b";
-          }
-          if (lineOutput.length() > 28)
-            lineOutput = lineOutput.substring(0, 28);
-          terminalOutputs.push_back(lineOutput);
+    // Cached listing, only an empty result needs the card to tell why
+    PocketmageDirCache::ListingPtr entries = PM_DIRS().list(listPath);
+    for (const PocketmageDirCache::Entry& e : *entries) {
+      String lineOutput = "";
+      if (e.isDir)
+        lineOutput += "[DIR]";
+      else
+        lineOutput += "     ";
+      lineOutput += e.name;
+      if (!e.isDir) {
+        lineOutput += " * ";
+        lineOutput += String(e.size) + "b";
+      }
+      if (lineOutput.length() > 28)
+        lineOutput = lineOutput.substring(0, 28);
+      terminalOutputs.push_back(lineOutput);
+    }
 
-          lineOutput = "";
-          file = dir.openNextFile();
-        }
-        dir.close();
-      } else {
+    if (entries->empty()) {
+      SDSession session;
+      File dir = global_fs->open(listPath);
+      if (!dir)
+        returnText = "ls: No such directory";
+      else if (!dir.isDirectory())
         returnText = "ls: Not a directory";
-      }
-    } else {
-      returnText = "ls: No such directory";
+      if (dir) dir.close();
     }
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -329,30 +328,33 @@ void funcSelect(String command) {
 
   // Make directory
   else if (command.startsWith("mkdir")) {
-    pocketmage::setCpuSpeed(240);
+    {
+      SDSession session;
+
+      // Format the path
+      String arg = command.substring(5);
+      arg.trim();
+      String newDirPath = currentDir;
+      if (arg.length() > 0) {
+        if (arg.startsWith("/"))
+          newDirPath = arg;
+        else {
+          if (!currentDir.endsWith("/"))
+            newDirPath = currentDir + "/";
+          newDirPath += arg;
+        }
+      } else {
+        returnText = "Path not defined";
+      }
 
-    // Format the path
-    String arg = command.substring(5);
-    arg.trim();
-    String newDirPath = currentDir;
-    if (arg.length() > 0) {
-      if (arg.startsWith("/"))
-        newDirPath = arg;
-      else {
-        if (!currentDir.endsWith("/"))
-          newDirPath = currentDir + "/";
-        newDirPath += arg;
+      // Create the directory
+      if (!global_fs->exists(newDirPath)) {
+        global_fs->mkdir(newDirPath);
+        PM_DIRS().invalidate(newDirPath);
       }
-    } else {
-      returnText = "Path not defined";
+      currentDir = newDirPath;
     }
 
-    // Create the directory
-    if (!global_fs->exists(newDirPath))
-      global_fs->mkdir(newDirPath);
-    currentDir = newDirPath;
-
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -364,71 +366,74 @@ void funcSelect(String command) {
 
   // Remove directory
   else if (command.startsWith("rm -r")) {
-    pocketmage::setCpuSpeed(240);
-    String arg = command.substring(5);
-    arg.trim();
+    {
+      SDSession session;
 
-    String dirPath = currentDir;
-    if (arg.length() > 0) {
-      if (arg.startsWith("/"))
-        dirPath = arg;
-      else {
-        if (!currentDir.endsWith("/"))
-          dirPath += "/";
-        dirPath += arg;
-      }
-    } else {
-      returnText = "Path not defined";
-    }
+      String arg = command.substring(5);
+      arg.trim();
 
-    if (returnText == "" && global_fs->exists(dirPath)) {
-      File root = global_fs->open(dirPath);
-      if (!root) {
-        returnText = "Failed to open path";
+      String dirPath = currentDir;
+      if (arg.length() > 0) {
+        if (arg.startsWith("/"))
+          dirPath = arg;
+        else {
+          if (!currentDir.endsWith("/"))
+            dirPath += "/";
+          dirPath += arg;
+        }
       } else {
-        if (!root.isDirectory()) {
-          // Simple file delete
-          if (!global_fs->remove(dirPath))
-            returnText = "Failed to remove file";
+        returnText = "Path not defined";
+      }
+
+      if (returnText == "" && global_fs->exists(dirPath)) {
+        File root = global_fs->open(dirPath);
+        if (!root) {
+          returnText = "Failed to open path";
         } else {
-          // Recursive directory delete
-          File entry;
-          while (true) {
-            entry = root.openNextFile();
-            if (!entry)
-              break;
-
-            String entryPath = dirPath;
-            if (!entryPath.endsWith("/"))
-              entryPath += "/";
-            entryPath += entry.name();
-
-            if (entry.isDirectory()) {
-              // recurse inline by reusing rm -r logic
-              String subCmd = "rm -r " + entryPath;
-              command = subCmd;
-              root.close();
-              pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-              newState = true;
-              return;
-            } else {
-              global_fs->remove(entryPath);
+          if (!root.isDirectory()) {
+            // Simple file delete
+            if (!global_fs->remove(dirPath))
+              returnText = "Failed to remove file";
+            PM_DIRS().invalidate(dirPath);
+          } else {
+            // Recursive directory delete
+            File entry;
+            while (true) {
+              entry = root.openNextFile();
+              if (!entry)
+                break;
+
+              String entryPath = dirPath;
+              if (!entryPath.endsWith("/"))
+                entryPath += "/";
+              entryPath += entry.name();
+
+              if (entry.isDirectory()) {
+                // recurse inline by reusing rm -r logic
+                String subCmd = "rm -r " + entryPath;
+                command = subCmd;
+                root.close();
+                newState = true;
+                return;
+              } else {
+                global_fs->remove(entryPath);
+                PM_DIRS().invalidate(entryPath);
+              }
+              entry.close();
             }
-            entry.close();
-          }
-          root.close();
+            root.close();
 
-          // directory now empty
-          if (!global_fs->rmdir(dirPath))
-            returnText = "Failed to remove directory";
+            // directory now empty
+            if (!global_fs->rmdir(dirPath))
+              returnText = "Failed to remove directory";
+            PM_DIRS().invalidate(dirPath);
+          }
         }
+      } else if (returnText == "") {
+        returnText = "Path not found";
       }
-    } else if (returnText == "") {
-      returnText = "Path not found";
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -441,41 +446,44 @@ void funcSelect(String command) {
 
   // Remove file
   else if (command.startsWith("rm ") && !command.startsWith("rm -r")) {
-    pocketmage::setCpuSpeed(240);
-    String arg = command.substring(2);
-    arg.trim();
+    {
+      SDSession session;
 
-    String dirPath = currentDir;
-    if (arg.length() > 0) {
-      if (arg.startsWith("/"))
-        dirPath = arg;
-      else {
-        if (!currentDir.endsWith("/"))
-          dirPath += "/";
-        dirPath += arg;
-      }
-    } else {
-      returnText = "Path not defined";
-    }
+      String arg = command.substring(2);
+      arg.trim();
 
-    if (returnText == "" && global_fs->exists(dirPath)) {
-      File f = global_fs->open(dirPath);
-      if (!f) {
-        returnText = "Failed to open file";
-      } else if (f.isDirectory()) {
-        returnText = "Not a file - use <rm -r>";
+      String dirPath = currentDir;
+      if (arg.length() > 0) {
+        if (arg.startsWith("/"))
+          dirPath = arg;
+        else {
+          if (!currentDir.endsWith("/"))
+            dirPath += "/";
+          dirPath += arg;
+        }
       } else {
-        f.close();  // REQUIRED
-        if (!global_fs->remove(dirPath))
-          returnText = "Delete failed";
+        returnText = "Path not defined";
+      }
+
+      if (returnText == "" && global_fs->exists(dirPath)) {
+        File f = global_fs->open(dirPath);
+        if (!f) {
+          returnText = "Failed to open file";
+        } else if (f.isDirectory()) {
+          returnText = "Not a file - use <rm -r>";
+        } else {
+          f.close();  // REQUIRED
+          if (!global_fs->remove(dirPath))
+            returnText = "Delete failed";
+          PM_DIRS().invalidate(dirPath);
+        }
+        if (f)
+          f.close();
+      } else if (returnText == "") {
+        returnText = "Path not found";
       }
-      if (f)
-        f.close();
-    } else if (returnText == "") {
-      returnText = "Path not found";
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -487,49 +495,42 @@ void funcSelect(String command) {
 
   // Copy file
   else if (command.startsWith("cp ")) {
-    pocketmage::setCpuSpeed(240);
+    {
+      SDSession session;
 
-    String args = command.substring(3);
-    args.trim();
+      String args = command.substring(3);
+      args.trim();
 
-    int spaceIdx = args.indexOf(' ');
-    if (spaceIdx == -1) {
-      returnText = "Usage: cp <src> <dest>";
-    } else {
-      String src = args.substring(0, spaceIdx);
-      String dest = args.substring(spaceIdx + 1);
-      src.trim();
-      dest.trim();
-
-      String srcPath =
-          src.startsWith("/") ? src : (currentDir + (currentDir.endsWith("/") ? "" : "/") + src);
-      String destPath =
-          dest.startsWith("/") ? dest : (currentDir + (currentDir.endsWith("/") ? "" : "/") + dest);
-
-      if (!global_fs->exists(srcPath)) {
-        returnText = "Source not found";
+      int spaceIdx = args.indexOf(' ');
+      if (spaceIdx == -1) {
+        returnText = "Usage: cp <src> <dest>";
       } else {
-        File srcFile = global_fs->open(srcPath, FILE_READ);
-        if (!srcFile || srcFile.isDirectory()) {
-          returnText = "Source is not a file";
+        String src = args.substring(0, spaceIdx);
+        String dest = args.substring(spaceIdx + 1);
+        src.trim();
+        dest.trim();
+
+        String srcPath =
+            src.startsWith("/") ? src : (currentDir + (currentDir.endsWith("/") ? "" : "/") + src);
+        String destPath =
+            dest.startsWith("/") ? dest : (currentDir + (currentDir.endsWith("/") ? "" : "/") + dest);
+
+        if (!global_fs->exists(srcPath)) {
+          returnText = "Source not found";
         } else {
-          File destFile = global_fs->open(destPath, FILE_WRITE);
-          if (!destFile) {
-            returnText = "Failed to create destination";
-          } else {
-            uint8_t buf[512];
-            size_t n;
-            while ((n = srcFile.read(buf, sizeof(buf))) > 0) {
-              destFile.write(buf, n);
-            }
-            destFile.close();
+          File srcFile = global_fs->open(srcPath, FILE_READ);
+          bool isFile = srcFile && !srcFile.isDirectory();
+          if (srcFile) srcFile.close();
+
+          if (!isFile) {
+            returnText = "Source is not a file";
+          } else if (!PM_SDAUTO().copyPath(srcPath, destPath, PocketmageSD::oledCopyProgress)) {
+            returnText = "Copy failed";
           }
-          srcFile.close();
         }
       }
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -541,54 +542,50 @@ void funcSelect(String command) {
 
   // Move file
   else if (command.startsWith("mv ")) {
-    pocketmage::setCpuSpeed(240);
+    {
+      SDSession session;
 
-    String args = command.substring(3);
-    args.trim();
+      String args = command.substring(3);
+      args.trim();
 
-    int spaceIdx = args.indexOf(' ');
-    if (spaceIdx == -1) {
-      returnText = "Usage: mv <src> <dest>";
-    } else {
-      String src = args.substring(0, spaceIdx);
-      String dest = args.substring(spaceIdx + 1);
-      src.trim();
-      dest.trim();
-
-      String srcPath =
-          src.startsWith("/") ? src : (currentDir + (currentDir.endsWith("/") ? "" : "/") + src);
-      String destPath =
-          dest.startsWith("/") ? dest : (currentDir + (currentDir.endsWith("/") ? "" : "/") + dest);
-
-      if (!global_fs->exists(srcPath)) {
-        returnText = "Source not found";
+      int spaceIdx = args.indexOf(' ');
+      if (spaceIdx == -1) {
+        returnText = "Usage: mv <src> <dest>";
       } else {
-        // Try fast rename first
-        if (!global_fs->rename(srcPath, destPath)) {
-          // Fallback: copy + delete
-          File srcFile = global_fs->open(srcPath, FILE_READ);
-          if (!srcFile || srcFile.isDirectory()) {
-            returnText = "Source is not a file";
-          } else {
-            File destFile = global_fs->open(destPath, FILE_WRITE);
-            if (!destFile) {
-              returnText = "Failed to create destination";
+        String src = args.substring(0, spaceIdx);
+        String dest = args.substring(spaceIdx + 1);
+        src.trim();
+        dest.trim();
+
+        String srcPath =
+            src.startsWith("/") ? src : (currentDir + (currentDir.endsWith("/") ? "" : "/") + src);
+        String destPath =
+            dest.startsWith("/") ? dest : (currentDir + (currentDir.endsWith("/") ? "" : "/") + dest);
+
+        if (!global_fs->exists(srcPath)) {
+          returnText = "Source not found";
+        } else {
+          // Try fast rename first, either way both directories change
+          PM_DIRS().invalidate(srcPath);
+          PM_DIRS().invalidate(destPath);
+          if (!global_fs->rename(srcPath, destPath)) {
+            // Fallback: copy + delete
+            File srcFile = global_fs->open(srcPath, FILE_READ);
+            bool isFile = srcFile && !srcFile.isDirectory();
+            if (srcFile) srcFile.close();
+
+            if (!isFile) {
+              returnText = "Source is not a file";
+            } else if (!PM_SDAUTO().copyPath(srcPath, destPath, PocketmageSD::oledCopyProgress)) {
+              returnText = "Copy failed";
             } else {
-              uint8_t buf[512];
-              size_t n;
-              while ((n = srcFile.read(buf, sizeof(buf))) > 0) {
-                destFile.write(buf, n);
-              }
-              destFile.close();
               global_fs->remove(srcPath);
             }
-            srcFile.close();
           }
         }
       }
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -600,35 +597,37 @@ void funcSelect(String command) {
 
   // Create empty file (touch)
   else if (command.startsWith("touch ")) {
-    pocketmage::setCpuSpeed(240);
-
-    String arg = command.substring(6);
-    arg.trim();
+    {
+      SDSession session;
 
-    if (arg.length() == 0) {
-      returnText = "Usage: touch <file>";
-    } else {
-      String filePath =
-          arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
+      String arg = command.substring(6);
+      arg.trim();
 
-      if (global_fs->exists(filePath)) {
-        File f = global_fs->open(filePath);
-        if (f && f.isDirectory()) {
-          returnText = "Is a directory";
-        }
-        if (f)
-          f.close();
+      if (arg.length() == 0) {
+        returnText = "Usage: touch <file>";
       } else {
-        File f = global_fs->open(filePath, FILE_WRITE);
-        if (!f) {
-          returnText = "Failed to create file";
+        String filePath =
+            arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
+
+        if (global_fs->exists(filePath)) {
+          File f = global_fs->open(filePath);
+          if (f && f.isDirectory()) {
+            returnText = "Is a directory";
+          }
+          if (f)
+            f.close();
         } else {
-          f.close();
+          File f = global_fs->open(filePath, FILE_WRITE);
+          if (!f) {
+            returnText = "Failed to create file";
+          } else {
+            f.close();
+            PM_DIRS().invalidate(filePath);
+          }
         }
       }
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
       OLED().oledWord(returnText);
@@ -640,45 +639,49 @@ void funcSelect(String command) {
 
   // Open in text editor
   else if (command.startsWith("txt ")) {
-    pocketmage::setCpuSpeed(240);
+    String openPath;
+    {
+      SDSession session;
 
-    String arg = command.substring(4);  // everything after "txt "
-    arg.trim();
+      String arg = command.substring(4);  // everything after "txt "
+      arg.trim();
 
-    if (arg.length() == 0) {
-      returnText = "Usage: txt <filename>";
-    } else {
-      // Ensure .txt extension or add it
-      if (!arg.endsWith(".txt")) {
-        int dotIdx = arg.lastIndexOf('.');
-        if (dotIdx != -1) {
-          returnText = "Only .txt files supported";
-        } else {
-          arg += ".txt";
+      if (arg.length() == 0) {
+        returnText = "Usage: txt <filename>";
+      } else {
+        // Ensure .txt extension or add it
+        if (!arg.endsWith(".txt")) {
+          int dotIdx = arg.lastIndexOf('.');
+          if (dotIdx != -1) {
+            returnText = "Only .txt files supported";
+          } else {
+            arg += ".txt";
+          }
         }
-      }
 
-      if (returnText == "") {
-        // Compute full path
-        String filePath =
-            arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
+        if (returnText == "") {
+          // Compute full path
+          String filePath =
+              arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
 
-        // Verify that file exists
-        if (!global_fs->exists(filePath)) {
-          returnText = "File not found";
-        } else {
-          // Open in TXT
-          PM_SDAUTO().setEditingFile(filePath);
-          OLED().oledWord("Opening: " + PM_SDAUTO().getEditingFile());
-          pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-          delay(1000);
-          TXT_INIT(filePath);
-          return;
+          // Verify that file exists
+          if (!global_fs->exists(filePath)) {
+            returnText = "File not found";
+          } else {
+            openPath = filePath;
+          }
         }
       }
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+    // Open in TXT
+    if (openPath != "") {
+      PM_SDAUTO().setEditingFile(openPath);
+      OLED().oledWord("Opening: " + PM_SDAUTO().getEditingFile());
+      delay(1000);
+      TXT_INIT(openPath);
+      return;
+    }
 
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
@@ -691,49 +694,53 @@ void funcSelect(String command) {
 
   // Open in potion
   else if (command.startsWith("potion") || command.startsWith("pot")) {
-    pocketmage::setCpuSpeed(240);
-
-    String arg = "";
-    if (command.startsWith("potion"))
-      arg = command.substring(6);
-    else if (command.startsWith("pot"))
-      arg = command.substring(3);
-    arg.trim();
-
-    if (arg.length() == 0) {
-      returnText = "Usage: potion <filename>";
-    } else {
-      // Ensure .txt extension or add it
-      if (!arg.endsWith(".c")) {
-        // Check if there's an extension at all
-        int dotIdx = arg.lastIndexOf('.');
-        if (dotIdx != -1) {
-          returnText = "Only .c files supported";
-        } else {
-          // Append .txt automatically
-          arg += ".c";
+    bool found = false;
+    {
+      SDSession session;
+
+      String arg = "";
+      if (command.startsWith("potion"))
+        arg = command.substring(6);
+      else if (command.startsWith("pot"))
+        arg = command.substring(3);
+      arg.trim();
+
+      if (arg.length() == 0) {
+        returnText = "Usage: potion <filename>";
+      } else {
+        // Ensure .txt extension or add it
+        if (!arg.endsWith(".c")) {
+          // Check if there's an extension at all
+          int dotIdx = arg.lastIndexOf('.');
+          if (dotIdx != -1) {
+            returnText = "Only .c files supported";
+          } else {
+            // Append .txt automatically
+            arg += ".c";
+          }
         }
-      }
 
-      if (returnText == "") {
-        // Compute full path
-        String filePath =
-            arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
+        if (returnText == "") {
+          // Compute full path
+          String filePath =
+              arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
 
-        // Verify that file exists
-        if (!global_fs->exists(filePath)) {
-          returnText = "File not found";
-        } else {
-          // Open in Potion
-          editFile = filePath;
-          pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-          potionInit();
-          return;
+          // Verify that file exists
+          if (!global_fs->exists(filePath)) {
+            returnText = "File not found";
+          } else {
+            editFile = filePath;
+            found = true;
+          }
         }
       }
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+    // Open in Potion
+    if (found) {
+      potionInit();
+      return;
+    }
 
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
@@ -746,49 +753,52 @@ void funcSelect(String command) {
 
   // Compile program
   else if (command.startsWith("brew")) {
-    pocketmage::setCpuSpeed(240);
+    bool found = false;
+    const char* wrenchCode = nullptr;
+    {
+      SDSession session;
 
-    String arg = command.substring(4);
+      String arg = command.substring(4);
 
-    arg.trim();
+      arg.trim();
 
-    if (arg.length() == 0) {
-      returnText = "Usage: brew <filename>";
-    } else {
-      // Ensure .txt extension or add it
-      if (!arg.endsWith(".c")) {
-        // Check if there's an extension at all
-        int dotIdx = arg.lastIndexOf('.');
-        if (dotIdx != -1) {
-          returnText = "Only .c files supported";
-        } else {
-          // Append .txt automatically
-          arg += ".c";
+      if (arg.length() == 0) {
+        returnText = "Usage: brew <filename>";
+      } else {
+        // Ensure .txt extension or add it
+        if (!arg.endsWith(".c")) {
+          // Check if there's an extension at all
+          int dotIdx = arg.lastIndexOf('.');
+          if (dotIdx != -1) {
+            returnText = "Only .c files supported";
+          } else {
+            // Append .txt automatically
+            arg += ".c";
+          }
         }
-      }
 
-      if (returnText == "") {
-        // Compute full path
-        String filePath =
-            arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
+        if (returnText == "") {
+          // Compute full path
+          String filePath =
+              arg.startsWith("/") ? arg : (currentDir + (currentDir.endsWith("/") ? "" : "/") + arg);
 
-        // Verify that file exists
-        if (!global_fs->exists(filePath)) {
-          returnText = "File not found";
-        } 
-        else {
-          // Compile and run with Wrench
-          // filePath
-          const char* wrenchCode = readCFile(filePath);
-          compileWrench(wrenchCode);
-
-          pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-          return;
+          // Verify that file exists
+          if (!global_fs->exists(filePath)) {
+            returnText = "File not found";
+          } 
+          else {
+            wrenchCode = readCFile(filePath);
+            found = true;
+          }
         }
       }
     }
 
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
+    // Compile and run with Wrench
+    if (found) {
+      compileWrench(wrenchCode);
+      return;
+    }
 
     if (returnText != "") {
       terminalOutputs.push_back(returnText);
@@ -799,6 +809,15 @@ void funcSelect(String command) {
     return;
   }
 
+  // SD buffering benchmark
+  else if (command == "sdbench") {
+    OLED().oledWord("Benchmarking SD...");
+    for (const String& line : PM_SDAUTO().benchmarkBuffered())
+      terminalOutputs.push_back(line);
+    newState = true;
+    return;
+  }
+
   // Check whether command is a home/settings command
   returnText = commandSelect(command);
   if (returnText != "") {
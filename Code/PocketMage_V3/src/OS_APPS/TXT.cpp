@@ -216,7 +216,6 @@ void processKB_TXT_OLD() {
             //Selected file does not exist, create a new one
             if (PM_SDAUTO().getFilesListIndex(fileIndex - 1) == "-") {
               CurrentTXTState = WIZ3;
-              EINK().setFullRefreshAfter(FULL_REFRESH_AFTER + 1);
               newState = true;
               display.fillScreen(GxEPD_WHITE);
             }
@@ -225,7 +224,6 @@ void processKB_TXT_OLD() {
               prevEditingFile = PM_SDAUTO().getEditingFile();
               PM_SDAUTO().setEditingFile(PM_SDAUTO().getFilesListIndex(fileIndex - 1));      
               CurrentTXTState = WIZ1;
-              EINK().setFullRefreshAfter(FULL_REFRESH_AFTER + 1);
               newState = true;
               display.fillScreen(GxEPD_WHITE);
             }
@@ -256,7 +254,6 @@ void processKB_TXT_OLD() {
         else if (inchar == 127 || inchar == 8) {                  
           CurrentTXTState = WIZ0;
           KB().setKeyboardState(FUNC);
-          EINK().setFullRefreshAfter(FULL_REFRESH_AFTER + 1);
           newState = true;
           display.fillScreen(GxEPD_WHITE);
         }
@@ -269,7 +266,6 @@ void processKB_TXT_OLD() {
               CurrentTXTState = WIZ2;
               currentWord = "";
               KB().setKeyboardState(NORMAL);
-              EINK().setFullRefreshAfter(FULL_REFRESH_AFTER + 1);
               newState = true;
               display.fillScreen(GxEPD_WHITE);
             }
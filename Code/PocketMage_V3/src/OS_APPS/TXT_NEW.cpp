@@ -188,6 +188,11 @@ enum EditingModes { edit_inline = 0, edit_append = 1 };
 uint8_t currentEditMode = edit_append;
 String currentLine = "";
 
+// First display line drawn on the e-ink, keeps a few lines of context above lineScroll
+ulong scrollTopIndex() {
+  return (lineScroll <= SCROLL_LINE_OFFSET) ? 0 : lineScroll - SCROLL_LINE_OFFSET;
+}
+
 struct wordObject {
   String text;
   bool bold;
@@ -197,6 +202,7 @@ struct wordObject {
 struct LineObject {
   ulong index;
   std::vector<wordObject> words;
+  uint16_t width = 0;  // E-ink pixel width, measured when the line is wrapped
 };
 
 // Document Line object
@@ -206,6 +212,7 @@ struct DocLine {
   std::vector<wordObject> words;  // Parsed words with formatting
   std::vector<LineObject> lines;  // split into line objects
   ulong orderedListNumber;
+  ulong firstIndex;               // Display index this block starts at, valid even with no lines
 
   // Parse the line into wordObjects
   void parseWords() {
@@ -256,19 +263,15 @@ struct DocLine {
     }
 
     lines.clear();
+    firstIndex = indexCounter;
     LineObject currentLine;
     int lineWidth = 0;
+    int lastSpaceWidth = 0;
 
     for (auto& w : words) {
-      const GFXfont* font = pickFont(style, w.bold, w.italic);
-      display.setFont(font);
-
-      int16_t x1, y1;
-      uint16_t wpx, hpx;
-      display.getTextBounds(w.text.c_str(), 0, 0, &x1, &y1, &wpx, &hpx);
-
-      int spaceWidth;
-      display.getTextBounds(SPACEWIDTH_SYMBOL, 0, 0, &x1, &y1, (uint16_t*)&spaceWidth, &hpx);
+      const FontMetrics& metrics = EINK().fontMetrics(pickFont(style, w.bold, w.italic));
+      uint16_t wpx = metrics.textWidth(w.text.c_str(), w.text.length());
+      int spaceWidth = metrics.textWidth(SPACEWIDTH_SYMBOL);
 
       // Calculate width for this word plus space
       int addWidth =
@@ -277,6 +280,7 @@ struct DocLine {
       // If the word doesn't fit, start a new line
       if (lineWidth > 0 && (lineWidth + addWidth > textWidth)) {
         currentLine.index = indexCounter++;
+        currentLine.width = lineWidth - lastSpaceWidth;  // no space after the last word
         lines.push_back(currentLine);
 
         currentLine.words.clear();
@@ -285,10 +289,12 @@ struct DocLine {
 
       currentLine.words.push_back(w);
       lineWidth += addWidth;
+      lastSpaceWidth = spaceWidth;
     }
 
     if (!currentLine.words.empty()) {
       currentLine.index = indexCounter++;
+      currentLine.width = lineWidth - lastSpaceWidth;
       lines.push_back(currentLine);
     }
   }
@@ -324,17 +330,20 @@ struct DocLine {
     line = compiled;
   }
 
+  // True when every display line of this block is above the given index
+  bool isAbove(ulong topIndex) const {
+    if (lines.empty())
+      return firstIndex < topIndex;
+    return lines.back().index < topIndex;
+  }
+
   int displayLine(int startX, int startY) {
-    ulong offsetLineScroll = 0;
-    if (lineScroll <= SCROLL_LINE_OFFSET) {
-      offsetLineScroll = 0;
-    } else
-      offsetLineScroll = lineScroll - SCROLL_LINE_OFFSET;
+    ulong offsetLineScroll = scrollTopIndex();
 
     int cursorY = startY;
 
     // Entire block is offscreen, do not render.
-    if (!lines.empty() && lines.back().index < offsetLineScroll) {
+    if (isAbove(offsetLineScroll)) {
       return 0;
     }
 
@@ -366,20 +375,24 @@ struct DocLine {
     
     // ---------- Render Text ---------- //
 
-    for (auto& ln : lines) {
-      if (ln.index < offsetLineScroll)
-        continue;  // skip lines above scroll
+    // Skip lines above scroll
+    auto firstVisible = std::partition_point(
+        lines.begin(), lines.end(),
+        [&](const LineObject& l) { return l.index < offsetLineScroll; });
+
+    for (auto it = firstVisible; it != lines.end(); ++it) {
+      auto& ln = *it;
+
+      // Stop once the bottom of the panel is reached
+      if (cursorY > display.height())
+        break;
 
       int cursorX = startX;
 
       // 1. Find max height for this line
       uint16_t max_hpx = 0;
       for (auto& w : ln.words) {
-        const GFXfont* font = pickFont(style, w.bold, w.italic);
-        display.setFont(font);
-        int16_t x1, y1;
-        uint16_t wpx, hpx;
-        display.getTextBounds(w.text.c_str(), cursorX, cursorY, &x1, &y1, &wpx, &hpx);
+        uint16_t hpx = EINK().fontMetrics(pickFont(style, w.bold, w.italic)).textHeight(w.text.c_str());
         if (hpx > max_hpx)
           max_hpx = hpx;
       }
@@ -391,22 +404,15 @@ struct DocLine {
       // 2. Draw all words at the same baseline
       for (auto& w : ln.words) {
         const GFXfont* font = pickFont(style, w.bold, w.italic);
+        const FontMetrics& metrics = EINK().fontMetrics(font);
         display.setFont(font);
 
-        int16_t x1, y1;
-        uint16_t wpx, hpx;
-        display.getTextBounds(w.text.c_str(), cursorX, cursorY, &x1, &y1, &wpx, &hpx);
-
         // Draw word at the baseline
         display.setCursor(cursorX, cursorY + max_hpx);
         display.print(w.text);
 
         // Advance cursor (word width + space)
-        int16_t sx1, sy1;
-        uint16_t sw, sh;
-        display.getTextBounds(SPACEWIDTH_SYMBOL, cursorX, cursorY, &sx1, &sy1, &sw, &sh);
-
-        cursorX += wpx + sw;
+        cursorX += metrics.textWidth(w.text.c_str(), w.text.length()) + metrics.textWidth(SPACEWIDTH_SYMBOL);
       }
 
       // Move down for next line
@@ -450,10 +456,10 @@ struct DocLine {
     else if (style == 'L') {
       String number = String(orderedListNumber) + ". ";
       const GFXfont* font = pickFont('T', false, false);
+      const FontMetrics& metrics = EINK().fontMetrics(font);
       display.setFont(font);
-      int16_t x1, y1;
-      uint16_t wpx, hpx;
-      display.getTextBounds(number.c_str(), 0, 0, &x1, &y1, &wpx, &hpx);
+      uint16_t wpx = metrics.textWidth(number.c_str());
+      uint16_t hpx = metrics.textHeight(number.c_str());
 
       display.setCursor(startX - wpx - 5, startY + hpx);
       display.print(number.c_str());
@@ -471,7 +477,7 @@ struct DocLine {
     int cursorY = startY;
 
     // Entire block is offscreen, do not render.
-    if (!lines.empty() && lines.back().index < lineScroll) {
+    if (isAbove(lineScroll)) {
       return 0;
     }
 
@@ -491,11 +497,16 @@ struct DocLine {
     else if (style == 'C')
       startX += (specialPadding / 2);
 
-    for (auto& ln : lines) {
-      if (ln.index < lineScroll)
-        continue;  // skip lines above scroll
+    // Skip lines above scroll
+    auto firstVisible = std::partition_point(
+        lines.begin(), lines.end(), [&](const LineObject& l) { return l.index < lineScroll; });
 
-      int cursorX = startX;
+    for (auto it = firstVisible; it != lines.end(); ++it) {
+      auto& ln = *it;
+
+      // Stop once the bottom of the OLED is reached
+      if (cursorY > u8g2.getDisplayHeight())
+        break;
 
       // 1. Find height for this line
       int max_hpx = 0;
@@ -532,23 +543,8 @@ struct DocLine {
           break;
       }
 
-      // 2. Draw all words at the same baseline
-      for (auto& w : ln.words) {
-        const GFXfont* font = pickFont(style, w.bold, w.italic);
-        display.setFont(font);
-
-        int16_t x1, y1;
-        uint16_t wpx, hpx;
-        display.getTextBounds(w.text.c_str(), cursorX, cursorY, &x1, &y1, &wpx, &hpx);
-
-        // Advance cursor (word width + space)
-        int16_t sx1, sy1;
-        uint16_t sw, sh;
-        display.getTextBounds(SPACEWIDTH_SYMBOL, cursorX, cursorY, &sx1, &sy1, &sw, &sh);
-
-        cursorX += wpx + sw;
-      }
-      uint16_t boxWidth = map(cursorX, 0, display.width(), 0, 76);
+      // 2. Scale the cached e-ink width down to the minimap
+      uint16_t boxWidth = map(startX + ln.width, 0, display.width(), 0, 76);
 
       u8g2.drawBox(startX + 2, cursorY, boxWidth, max_hpx);
 
@@ -605,6 +601,58 @@ struct DocLine {
 ulong editingLine_index = 0;
 std::vector<DocLine> docLines;
 
+// ------------------ Document Stats ------------------
+// Kept up to date as edits happen so saving never has to re-read the file to count it
+struct DocStats {
+  long words = 0;
+  long chars = 0;  // Words joined by single spaces, Markdown markers excluded
+  long lines = 0;  // One per DocLine, same as the saved file
+
+  DocStats& operator+=(const DocStats& o) {
+    words += o.words;
+    chars += o.chars;
+    lines += o.lines;
+    return *this;
+  }
+  DocStats& operator-=(const DocStats& o) {
+    words -= o.words;
+    chars -= o.chars;
+    lines -= o.lines;
+    return *this;
+  }
+};
+DocStats docStats;
+ulong docStatsGeneration = 0;  // Bumped on every full recount (file loads)
+
+DocStats countDocLine(const DocLine& dl) {
+  DocStats stats;
+  stats.lines = 1;
+
+  // Horizontal rules hold "---" as a word but it isn't text
+  if (dl.style == 'H')
+    return stats;
+
+  for (const auto& ln : dl.lines) {
+    for (const auto& w : ln.words) {
+      if (w.text.length() == 0)
+        continue;
+      // Same rule as the metadata char count, the joining space counts as one
+      stats.chars += PocketmageStore::countVisibleChars(w.text.c_str(), w.text.length()) +
+                     (stats.words > 0 ? 1 : 0);
+      stats.words++;
+    }
+  }
+  return stats;
+}
+
+void recountDocStats() {
+  docStatsGeneration++;
+  docStats = DocStats();
+  for (const auto& dl : docLines) {
+    docStats += countDocLine(dl);
+  }
+}
+
 // ------------------ Rendering ------------------
 
 // Count number of display lines
@@ -616,19 +664,24 @@ int getTotalDisplayLines() {
   return total;
 }
 
-// Display the entire document
+// Index of the first DocLine with a display line at or below topIndex
+size_t firstVisibleDocLine(ulong topIndex) {
+  auto it = std::partition_point(docLines.begin(), docLines.end(),
+                                 [&](const DocLine& doc) { return doc.isAbove(topIndex); });
+  return it - docLines.begin();
+}
+
+// Display the part of the document that fits on the panel
 int displayDocument(int startX = 0, int startY = 0) {
   int cursorY = startY;
 
-  for (auto& doc : docLines) {
-    // Display this DocLine, offset by current cursorY
-    int heightUsed = doc.displayLine(startX, cursorY);
-
+  for (size_t i = firstVisibleDocLine(scrollTopIndex()); i < docLines.size(); i++) {
     // If the line is off the bottom of the screen, stop drawing
     if (cursorY > display.height())
       break;
 
-    cursorY += heightUsed;
+    // Display this DocLine, offset by current cursorY
+    cursorY += docLines[i].displayLine(startX, cursorY);
   }
 
   // Return total height used
@@ -638,15 +691,13 @@ int displayDocument(int startX = 0, int startY = 0) {
 int displayDocumentPreview(int startX = 0, int startY = 0) {
   int cursorY = startY;
 
-  for (auto& doc : docLines) {
-    // Display this DocLine, offset by current cursorY
-    int heightUsed = doc.displayLinePreview(startX, cursorY);
-
+  for (size_t i = firstVisibleDocLine(lineScroll); i < docLines.size(); i++) {
     // If the line is off the bottom of the screen, stop drawing
     if (cursorY > u8g2.getDisplayHeight())
       break;
 
-    cursorY += heightUsed;
+    // Display this DocLine, offset by current cursorY
+    cursorY += docLines[i].displayLinePreview(startX, cursorY);
   }
 
   // Return total height used
@@ -768,26 +819,28 @@ void setFontOLED(bool bold, bool italic) {
   return;
 }
 
+// Binary search for the DocLine holding display line targetIndex, nullptr if none does
+DocLine* getDocLineByIndex(ulong targetIndex) {
+  size_t i = firstVisibleDocLine(targetIndex);
+  if (i >= docLines.size() || docLines[i].lines.empty() ||
+      docLines[i].lines.front().index > targetIndex)
+    return nullptr;
+  return &docLines[i];
+}
+
 LineObject* getLineObjectByIndex(ulong targetIndex) {
-  for (auto& doc : docLines) {
-    for (auto& line : doc.lines) {
-      if (line.index == targetIndex) {
-        return &line;
-      }
-    }
-  }
-  return nullptr;  // not found
+  DocLine* doc = getDocLineByIndex(targetIndex);
+  if (!doc)
+    return nullptr;  // not found
+
+  auto it = std::partition_point(doc->lines.begin(), doc->lines.end(),
+                                 [&](const LineObject& l) { return l.index < targetIndex; });
+  return (it != doc->lines.end() && it->index == targetIndex) ? &*it : nullptr;
 }
 
 char getStyleFromScrollLine(ulong scrollLineIndex) {
-  for (auto& doc : docLines) {
-    for (auto& line : doc.lines) {
-      if (line.index == scrollLineIndex) {
-        return doc.style;  // <-- Return the DocLine style
-      }
-    }
-  }
-  return 'T';  // fallback if not found
+  DocLine* doc = getDocLineByIndex(scrollLineIndex);
+  return doc ? doc->style : 'T';  // fallback if not found
 }
 
 // Returns the pixel width of a LineObject on the OLED (vector of wordObjects)
@@ -820,88 +873,83 @@ void scrollPreview() {
     return;
   }
 
-  LineObject scrollLine = *getLineObjectByIndex(lineScroll);
+  const LineObject& scrollLine = *scrollLinePtr;
 
-  if (&scrollLine) {
-    // Display Line
+  // Display Line
+  uint16_t xpos = xInit;
 
-    uint16_t xpos = xInit;
-
-    // Iterate through line and display from left to right
-    for (size_t i = 0; i < scrollLine.words.size(); ++i) {
-      const auto& w = scrollLine.words[i];
-      setFontOLED(w.bold, w.italic);
-      u8g2.drawStr(xpos, 20, w.text.c_str());
+  // Iterate through line and display from left to right
+  for (size_t i = 0; i < scrollLine.words.size(); ++i) {
+    const auto& w = scrollLine.words[i];
+    setFontOLED(w.bold, w.italic);
+    u8g2.drawStr(xpos, 20, w.text.c_str());
 
-      uint16_t wpx = u8g2.getStrWidth(w.text.c_str());
+    uint16_t wpx = u8g2.getStrWidth(w.text.c_str());
 
-      // Only add space if not the last word
-      if (i < scrollLine.words.size() - 1) {
-        uint8_t spaceWidth = u8g2.getStrWidth(" ");
-        xpos += wpx + spaceWidth;
-      } else {
-        xpos += wpx;  // just the word width
-      }
+    // Only add space if not the last word
+    if (i < scrollLine.words.size() - 1) {
+      uint8_t spaceWidth = u8g2.getStrWidth(" ");
+      xpos += wpx + spaceWidth;
+    } else {
+      xpos += wpx;  // just the word width
     }
+  }
 
-    // Draw line number and type
-    char style = getStyleFromScrollLine(lineScroll);
-    String lineTypeLabel = "";
+  // Draw line number and type
+  char style = getStyleFromScrollLine(lineScroll);
+  String lineTypeLabel = "";
 
-    switch (style) {
-      case 'T':
-        lineTypeLabel = "BODY";
-        break;
-      case '1':
-        lineTypeLabel = "HEAD 1";
-        break;
-      case '2':
-        lineTypeLabel = "HEAD 2";
-        break;
-      case '3':
-        lineTypeLabel = "HEAD 3";
-        break;
-      case 'C':
-        lineTypeLabel = "CODE BLK";
-        break;
-      case '>':
-        lineTypeLabel = "QUOTE BLK";
-        break;
-      case '-':
-        lineTypeLabel = "UNORD LIST";
-        break;
-      case 'L':
-        lineTypeLabel = "ORDER LIST";
-        break;
-      case 'H':
-        lineTypeLabel = "HORIZ RULE";
-        break;
-      case 'B':
-        lineTypeLabel = "BLANK LINE";
-        break;
-      default:
-        lineTypeLabel = "?";
-        break;
-    }
+  switch (style) {
+    case 'T':
+      lineTypeLabel = "BODY";
+      break;
+    case '1':
+      lineTypeLabel = "HEAD 1";
+      break;
+    case '2':
+      lineTypeLabel = "HEAD 2";
+      break;
+    case '3':
+      lineTypeLabel = "HEAD 3";
+      break;
+    case 'C':
+      lineTypeLabel = "CODE BLK";
+      break;
+    case '>':
+      lineTypeLabel = "QUOTE BLK";
+      break;
+    case '-':
+      lineTypeLabel = "UNORD LIST";
+      break;
+    case 'L':
+      lineTypeLabel = "ORDER LIST";
+      break;
+    case 'H':
+      lineTypeLabel = "HORIZ RULE";
+      break;
+    case 'B':
+      lineTypeLabel = "BLANK LINE";
+      break;
+    default:
+      lineTypeLabel = "?";
+      break;
+  }
 
-    String lineInfoStr = "L:" + String(lineScroll) + "-" + lineTypeLabel;
+  String lineInfoStr = "L:" + String(lineScroll) + "-" + lineTypeLabel;
 
-    u8g2.setFont(u8g2_font_5x7_tf);
-    u8g2.drawStr(xInit, u8g2.getDisplayHeight(), lineInfoStr.c_str());
+  u8g2.setFont(u8g2_font_5x7_tf);
+  u8g2.drawStr(xInit, u8g2.getDisplayHeight(), lineInfoStr.c_str());
 
-    // Draw tooltip
-    u8g2.drawStr(u8g2.getDisplayWidth() - u8g2.getStrWidth("Tab:Edit Inline"),
-                 u8g2.getDisplayHeight(), "Tab:Edit Inline");
+  // Draw tooltip
+  u8g2.drawStr(u8g2.getDisplayWidth() - u8g2.getStrWidth("Tab:Edit Inline"),
+               u8g2.getDisplayHeight(), "Tab:Edit Inline");
 
-    // Draw Seperator
-    u8g2.drawVLine(80, 0, u8g2.getDisplayHeight());
+  // Draw Seperator
+  u8g2.drawVLine(80, 0, u8g2.getDisplayHeight());
 
-    // Draw Preview
-    int totalUsed = displayDocumentPreview(0, 0);
+  // Draw Preview
+  int totalUsed = displayDocumentPreview(0, 0);
 
-  } else {
-    return;
-  }
   u8g2.sendBuffer();
 }
 
@@ -930,8 +978,16 @@ void oledEditorDisplay(LineObject& lineObj, wordObject& currentWord, int pixelsU
       }
     }
 
-    if (lineHasText(lineObj))
+    if (lineHasText(lineObj)) {
       u8g2.drawVLine(xpos + 2, 1, 22);
+    } else {
+      // Nothing typed on this line yet, show document stats instead
+      String statsStr = "W:" + String(docStats.words) + " C:" + String(docStats.chars) +
+                        " L:" + String(docStats.lines);
+      u8g2.setFont(u8g2_font_5x7_tf);
+      u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(statsStr.c_str())) / 2, 16,
+                   statsStr.c_str());
+    }
   } else {
     // Line is too long to fit, display from right to left
     uint16_t xpos = u8g2.getDisplayWidth() - 8;
@@ -1023,6 +1079,8 @@ void populateLines(std::vector<DocLine>& docLines) {
     doc.parseWords();
     doc.splitToLines();
   }
+
+  recountDocStats();
 }
 
 void refreshOrderedListIndexes() {
@@ -1045,6 +1103,7 @@ void refreshAllLineIndexes() {
   // Refresh line indexes
   indexCounter = 0;                     // reset counter if you want indexes to start from 0
   for (auto& docLine : docLines) {      // iterate through all DocLines
+    docLine.firstIndex = indexCounter;
     for (auto& line : docLine.lines) {  // iterate through each LineObject
       line.index = indexCounter++;
     }
@@ -1081,13 +1140,62 @@ void loadMarkdownFile(const String& path) {
     return;
   }
 
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
-
   docLines.clear();
-  File file = global_fs->open(path.c_str(), FILE_READ);
-  if (!file) {
+  bool opened;
+  {
+    SDSession session;
+
+    PocketmageFile file;
+    opened = file.open(path, FILE_READ);
+    while (opened && file.available()) {
+      String line = file.readStringUntil('\n');
+      line.trim();
+      char style = 'T';
+      String content = line;  // default is full line
+
+      if (line.length() == 0) {
+        style = 'B'; // Blank line
+        content = "";
+      } else if (line.startsWith("### ")) {
+        style = '3'; // Heading 3
+        content = line.substring(4);  // remove "### "
+      } else if (line.startsWith("## ")) {
+        style = '2'; // Heading 2
+        content = line.substring(3);  // remove "## "
+      } else if (line.startsWith("# ")) {
+        style = '1'; // Heading 1
+        content = line.substring(2);  // remove "# "
+      } else if (line.startsWith("> ")) {
+        style = '>'; // Quote Block
+        content = line.substring(2);  // remove "> "
+      } else if (line.startsWith("- ")) {
+        style = '-'; // Unordered List
+        content = line.substring(2); // remove "- "
+      } else if (line == "---") {
+        style = 'H'; // Horizontal Rule
+        content = "---";  // horizontal line has no content
+      } else if ((line.startsWith("```")) || (line.startsWith("`") && line.endsWith("`")) || (line.startsWith("```") && line.endsWith("```"))) {
+        if (line.startsWith("```"))
+          content = line.substring(3);
+        else if (line.startsWith("```") && line.endsWith("```"))
+          content = line.substring(3, line.length() - 3);
+        else if (line.startsWith("`") && line.endsWith("`"))
+          content = line.substring(1, line.length() - 1);
+
+        style = 'C'; // Code Block
+      } else if (line.length() > 2 && isDigit(line.charAt(0)) && line.charAt(1) == '.' &&
+                 line.charAt(2) == ' ') {
+        style = 'L'; // Ordered List
+        content = line.substring(3); // remove "1. ", "2. ", etc.
+      }
+
+      docLines.push_back({style, content, {}});
+    }
+
+    file.close();
+  }
+
+  if (!opened) {
     ESP_LOGE("SD", "File does not exist: %s", path.c_str());  // FIXME: - Come up with better error handling
                                                               //        - Should this be Error or Warning?
     OLED().oledWord("LOAD FAILED - FILE MISSING");
@@ -1101,59 +1209,9 @@ void loadMarkdownFile(const String& path) {
     populateLines(docLines);
     refreshAllLineIndexes();
 
-    if (SAVE_POWER)
-      pocketmage::setCpuSpeed(80);
-    SDActive = false;
     return;
   }
 
-  while (file.available()) {
-    String line = file.readStringUntil('\n');
-    line.trim();
-    char style = 'T';
-    String content = line;  // default is full line
-
-    if (line.length() == 0) {
-      style = 'B'; // Blank line
-      content = "";
-    } else if (line.startsWith("### ")) {
-      style = '3'; // Heading 3
-      content = line.substring(4);  // remove "### "
-    } else if (line.startsWith("## ")) {
-      style = '2'; // Heading 2
-      content = line.substring(3);  // remove "## "
-    } else if (line.startsWith("# ")) {
-      style = '1'; // Heading 1
-      content = line.substring(2);  // remove "# "
-    } else if (line.startsWith("> ")) {
-      style = '>'; // Quote Block
-      content = line.substring(2);  // remove "> "
-    } else if (line.startsWith("- ")) {
-      style = '-'; // Unordered List
-      content = line.substring(2); // remove "- "
-    } else if (line == "---") {
-      style = 'H'; // Horizontal Rule
-      content = "---";  // horizontal line has no content
-    } else if ((line.startsWith("```")) || (line.startsWith("`") && line.endsWith("`")) || (line.startsWith("```") && line.endsWith("```"))) {
-      if (line.startsWith("```"))
-        content = line.substring(3);
-      else if (line.startsWith("```") && line.endsWith("```"))
-        content = line.substring(3, line.length() - 3);
-      else if (line.startsWith("`") && line.endsWith("`"))
-        content = line.substring(1, line.length() - 1);
-
-      style = 'C'; // Code Block
-    } else if (line.length() > 2 && isDigit(line.charAt(0)) && line.charAt(1) == '.' &&
-               line.charAt(2) == ' ') {
-      style = 'L'; // Ordered List
-      content = line.substring(3); // remove "1. ", "2. ", etc.
-    }
-
-    docLines.push_back({style, content, {}});
-  }
-
-  file.close();
-
   if (docLines.empty()) {
     docLines.push_back({'T', "", {}});
     editingLine_index = 0;
@@ -1167,15 +1225,83 @@ void loadMarkdownFile(const String& path) {
   // Update indexes
   refreshAllLineIndexes();
 
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(80);
-  SDActive = false;
-
   OLED().oledWord("FILE LOADED");
   delay(500);
   fileLoaded = true;
 }
 
+// ------------------ Markdown Serializer ------------------
+// Streams the document model straight to a file without building Strings,
+// the file's write-behind buffer turns the small writes into whole-sector ones
+struct MarkdownWriter {
+  PocketmageFile& file;
+  size_t total = 0;       // bytes the file accepted
+  size_t requested = 0;   // bytes we asked it to write
+  size_t visible = 0;     // visible chars written, what writeMetadata() would count in the file
+
+  explicit MarkdownWriter(PocketmageFile& f) : file(f) {}
+
+  void write(const char* s, size_t n) {
+    requested += n;
+    visible += PocketmageStore::countVisibleChars(s, n);
+    total += file.write((const uint8_t*)s, n);
+  }
+
+  void write(const char* s) { write(s, strlen(s)); }
+
+  // Emit the bold/italic marker for a word
+  void writeMarker(const wordObject& w) {
+    if (w.bold && w.italic)
+      write("***", 3);
+    else if (w.bold)
+      write("**", 2);
+    else if (w.italic)
+      write("*", 1);
+  }
+
+  // Emit the words of a DocLine separated by single spaces
+  void writeWords(const DocLine& dl) {
+    bool first = true;
+    for (const auto& ln : dl.lines) {
+      for (const auto& w : ln.words) {
+        // Skip the empty word left behind by the editor
+        if (w.text.length() == 0)
+          continue;
+        if (!first)
+          write(" ", 1);
+        writeMarker(w);
+        write(w.text.c_str(), w.text.length());
+        writeMarker(w);
+        first = false;
+      }
+    }
+  }
+
+  // Emit one DocLine as a line of Markdown
+  void writeDocLine(const DocLine& dl) {
+    switch (dl.style) {
+      case '1': write("# ", 2); break;
+      case '2': write("## ", 3); break;
+      case '3': write("### ", 4); break;
+      case '>': write("> ", 2); break;
+      case '-': write("- ", 2); break;
+      case 'L': write("1. ", 3); break;
+      case 'C': write("```", 3); break;
+      default: break;
+    }
+
+    if (dl.style == 'H')
+      write("---", 3);
+    else if (dl.style != 'B')
+      writeWords(dl);
+
+    if (dl.style == 'C')
+      write("```", 3);
+
+    write("\r\n", 2);
+  }
+};
+
 void saveMarkdownFile(const String& path) {
   if (PM_SDAUTO().getNoSD()) {
     OLED().oledWord("SAVE FAILED - No SD!");
@@ -1183,9 +1309,6 @@ void saveMarkdownFile(const String& path) {
     return;
   }
   ESP_LOGE(TAG, "In save markdown file, setting cpu speed");
-  SDActive = true;
-  pocketmage::setCpuSpeed(240);
-  delay(50);
 
   // Determine save path
   String savePath = path;
@@ -1194,49 +1317,49 @@ void saveMarkdownFile(const String& path) {
   if (!savePath.startsWith("/"))
     savePath = "/" + savePath;
 
-  File file = global_fs->open(savePath.c_str(), FILE_WRITE);
-  if (!file) {
-    OLED().oledWord("SAVE FAILED - OPEN ERR");
-    delay(2000);
-    ESP_LOGE("SD", "Failed to open file for writing: %s", savePath.c_str());
-    SDActive = false;
-    return;
-  }
+  String failed;   // OLED message, shown once the session is closed
+  {
+    SDSession session;
 
-  // Write each DocLine as Markdown
-  for (auto &dl : docLines) {
-    dl.compileToText();
+    PocketmageFile file;
+    if (!file.open(savePath, FILE_WRITE)) {
+      ESP_LOGE("SD", "Failed to open file for writing: %s", savePath.c_str());
+      failed = "SAVE FAILED - OPEN ERR";
+    } else {
+      // Stream each DocLine as Markdown
+      ulong saveStart = millis();
+      MarkdownWriter writer(file);
+      for (const auto& dl : docLines) {
+        writer.writeDocLine(dl);
+      }
 
-    String out;
+      // close() flushes the last buffer, a failure there only shows up in getWriteError()
+      file.close();
+      PM_DIRS().invalidate(savePath);
 
-    switch (dl.style) {
-      case '1': out = "# " + dl.line; break;
-      case '2': out = "## " + dl.line; break;
-      case '3': out = "### " + dl.line; break;
-      case '>': out = "> " + dl.line; break;
-      case '-': out = "- " + dl.line; break;
-      case 'L': out = "1. " + dl.line; break; //String(dl.orderedListNumber) + ". " + dl.line; break;
-      case 'H': out = "---"; break;
-      case 'C': out = "```" + dl.line + "```"; break;
-      case 'B': out = ""; break;
-      default:  out = dl.line; break;
-    }
+      long onCard = PM_STORE().fileSize(savePath.c_str());
+      if (writer.total != writer.requested || file.getWriteError() || onCard != (long)writer.requested) {
+        ESP_LOGE("SD", "Short write while saving %s: %u of %u bytes, %ld on card", savePath.c_str(),
+                 (unsigned)writer.total, (unsigned)writer.requested, onCard);
+        failed = "SAVE FAILED - WRITE ERR";
+      } else {
+        ESP_LOGI(TAG, "Saved %u bytes in %lu ms", (unsigned)writer.total, millis() - saveStart);
 
-    file.println(out);
+        // Save metadata
+        PM_SDAUTO().writeMetadata(savePath, (long)writer.visible);
+        PM_SDAUTO().setEditingFile(savePath);
+      }
+    }
   }
 
-  file.close();
-
-  // Save metadata
-  PM_SDAUTO().writeMetadata(savePath);
-  PM_SDAUTO().setEditingFile(savePath);
+  if (failed.length() > 0) {
+    OLED().oledWord(failed);
+    delay(2000);
+    return;
+  }
 
   OLED().oledWord("Saved: " + savePath);
   delay(1000);
-
-  if (SAVE_POWER)
-    pocketmage::setCpuSpeed(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 void newMarkdownFile(const String& path) {
@@ -1246,10 +1369,6 @@ void newMarkdownFile(const String& path) {
     return;
   }
 
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
-
   // Determine save path
   String savePath = path;
   if (savePath == "" || savePath == "-")
@@ -1257,32 +1376,36 @@ void newMarkdownFile(const String& path) {
   if (!savePath.startsWith("/"))
     savePath = "/" + savePath;
 
-  File file = global_fs->open(savePath.c_str(), FILE_WRITE);
-  if (!file) {
+  bool created;
+  {
+    SDSession session;
+
+    File file = global_fs->open(savePath.c_str(), FILE_WRITE);
+    created = (bool)file;
+    if (created) {
+      // Write nothing
+
+      file.close();
+      PM_DIRS().invalidate(savePath);
+
+      // Save metadata
+      PM_SDAUTO().writeMetadata(savePath, 0);
+      PM_SDAUTO().setEditingFile(savePath);
+    }
+  }
+
+  if (!created) {
     OLED().oledWord("SAVE FAILED - OPEN ERR");
     delay(2000);
     ESP_LOGE("SD", "Failed to open file for writing: %s", savePath.c_str());
-    SDActive = false;
     return;
   }
 
-  // Write nothing
-
-  file.close();
-
-  // Save metadata
-  PM_SDAUTO().writeMetadata(savePath);
-  PM_SDAUTO().setEditingFile(savePath);
-
   OLED().oledWord("Created: " + savePath);
   delay(1000);
 
   loadMarkdownFile(savePath);
   updateScreen = true;
-
-  if (SAVE_POWER)
-    setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 
@@ -1290,15 +1413,9 @@ void newMarkdownFile(const String& path) {
 int getLineWidth(const LineObject& lineObj, char style) {
   int lineWidth = 0;
   for (const auto& w : lineObj.words) {
-    const GFXfont* font = pickFont(style, w.bold, w.italic);
-    display.setFont(font);
-
-    int16_t x1, y1;
-    uint16_t wpx, hpx;
-    display.getTextBounds(w.text.c_str(), 0, 0, &x1, &y1, &wpx, &hpx);
-
-    uint16_t spaceWidth;
-    display.getTextBounds(SPACEWIDTH_SYMBOL, 0, 0, &x1, &y1, &spaceWidth, &hpx);
+    const FontMetrics& metrics = EINK().fontMetrics(pickFont(style, w.bold, w.italic));
+    uint16_t wpx = metrics.textWidth(w.text.c_str(), w.text.length());
+    uint16_t spaceWidth = metrics.textWidth(SPACEWIDTH_SYMBOL);
 
     // Add word width + space width (except after last word)
     lineWidth += (wpx + WORDWIDTH_BUFFER);
@@ -1309,6 +1426,250 @@ int getLineWidth(const LineObject& lineObj, char style) {
   return lineWidth;
 }
 
+// ------------------ Find & Replace ------------------
+// Matching runs over the plain text of each DocLine (words joined by single spaces,
+// formatting markers excluded) with a case-insensitive KMP automaton, so nothing is copied.
+String findQuery = "";
+std::vector<uint16_t> findTable;  // KMP failure table for findQuery
+size_t findDoc = 0;               // DocLine of the last hit
+long findPos = -1;                // Offset of the last hit in that DocLine
+
+// Calls fn(c, word) for every char of a DocLine's plain text, word is nullptr for separators
+template <typename F>
+void forEachDocChar(const DocLine& dl, F fn) {
+  bool first = true;
+  for (const auto& ln : dl.lines) {
+    for (const auto& w : ln.words) {
+      if (w.text.length() == 0)
+        continue;
+      if (!first)
+        fn(' ', (const wordObject*)nullptr);
+      for (size_t i = 0; i < w.text.length(); i++) {
+        fn(w.text[i], &w);
+      }
+      first = false;
+    }
+  }
+}
+
+void setFindQuery(const String& query) {
+  findQuery = query;
+  findQuery.toLowerCase();
+  size_t m = findQuery.length();
+
+  findTable.assign(m, 0);
+  uint16_t k = 0;
+  for (size_t i = 1; i < m; i++) {
+    while (k > 0 && findQuery[i] != findQuery[k])
+      k = findTable[k - 1];
+    if (findQuery[i] == findQuery[k])
+      k++;
+    findTable[i] = k;
+  }
+}
+
+// Collect the start offsets of every match in a DocLine
+void findInDocLine(const DocLine& dl, std::vector<size_t>& hits, bool overlapping) {
+  const size_t m = findQuery.length();
+  if (m == 0 || dl.style == 'H' || dl.style == 'B')
+    return;
+
+  size_t pos = 0;
+  uint16_t k = 0;
+  forEachDocChar(dl, [&](char c, const wordObject*) {
+    c = tolower(c);
+    while (k > 0 && c != findQuery[k])
+      k = findTable[k - 1];
+    if (c == findQuery[k])
+      k++;
+    if (k == m) {
+      hits.push_back(pos + 1 - m);
+      k = overlapping ? findTable[k - 1] : 0;
+    }
+    pos++;
+  });
+}
+
+// Display line index that holds a plain text offset of a DocLine
+ulong displayLineAt(const DocLine& dl, size_t offset) {
+  size_t pos = 0;
+  for (const auto& ln : dl.lines) {
+    for (const auto& w : ln.words) {
+      if (w.text.length() == 0)
+        continue;
+      pos += w.text.length() + 1;
+      if (offset < pos)
+        return ln.index;
+    }
+  }
+  return dl.lines.empty() ? 0 : dl.lines.back().index;
+}
+
+// DocLine that holds a display line index
+size_t docIndexAtLine(ulong lineIndex) {
+  // Same binary search as drawing, then past any DocLine that has no display lines yet
+  size_t d = firstVisibleDocLine(lineIndex);
+  while (d < docLines.size() && docLines[d].lines.empty())
+    d++;
+  if (d < docLines.size())
+    return d;
+  return docLines.empty() ? 0 : docLines.size() - 1;
+}
+
+// Jump to the next or previous match, wrapping around the document once
+bool findStep(bool forward) {
+  const size_t n = docLines.size();
+  if (findQuery.length() == 0 || n == 0)
+    return false;
+  if (findDoc >= n) {
+    findDoc = n - 1;
+    findPos = -1;
+  }
+
+  std::vector<size_t> hits;
+  for (size_t step = 0; step <= n; step++) {
+    size_t d = forward ? (findDoc + step) % n : (findDoc + n - (step % n)) % n;
+    hits.clear();
+    findInDocLine(docLines[d], hits, true);
+    if (hits.empty())
+      continue;
+
+    long hit = -1;
+    if (forward) {
+      for (size_t h : hits) {
+        if (step > 0 || (long)h > findPos) {
+          hit = h;
+          break;
+        }
+      }
+    } else {
+      for (size_t i = hits.size(); i-- > 0;) {
+        if (step > 0 || (long)hits[i] < findPos) {
+          hit = hits[i];
+          break;
+        }
+      }
+    }
+    if (hit < 0)
+      continue;
+
+    findDoc = d;
+    findPos = hit;
+    lineScroll = displayLineAt(docLines[d], hit);
+    updateScreen = true;
+    return true;
+  }
+  return false;
+}
+
+// Rebuild a DocLine's words with every hit replaced, each new word keeps the
+// formatting of its first character
+void replaceInDocLine(DocLine& dl, const std::vector<size_t>& hits, const String& with) {
+  const size_t m = findQuery.length();
+  std::vector<wordObject> out;
+  wordObject cur = {"", false, false};
+
+  auto emit = [&](char c, bool bold, bool italic) {
+    if (c == ' ') {
+      if (cur.text.length() > 0)
+        out.push_back(std::move(cur));
+      cur = {"", false, false};
+      return;
+    }
+    if (cur.text.length() == 0) {
+      cur.bold = bold;
+      cur.italic = italic;
+    }
+    cur.text += c;
+  };
+
+  size_t pos = 0, h = 0, skip = 0;
+  forEachDocChar(dl, [&](char c, const wordObject* w) {
+    bool bold = w && w->bold;
+    bool italic = w && w->italic;
+    if (h < hits.size() && pos == hits[h]) {
+      for (size_t i = 0; i < with.length(); i++) {
+        emit(with[i], bold, italic);
+      }
+      skip = m;
+      h++;
+    }
+    if (skip > 0)
+      skip--;
+    else
+      emit(c, bold, italic);
+    pos++;
+  });
+  if (cur.text.length() > 0)
+    out.push_back(std::move(cur));
+
+  dl.words = std::move(out);
+}
+
+// Replace every match, only the DocLines that changed are re-wrapped
+int replaceAll(const String& with) {
+  int count = 0;
+  std::vector<size_t> hits;
+
+  for (auto& dl : docLines) {
+    hits.clear();
+    findInDocLine(dl, hits, false);
+    if (hits.empty())
+      continue;
+
+    docStats -= countDocLine(dl);
+
+    // Keep a pending space the user already typed
+    bool trailingSpace = !dl.lines.empty() && !dl.lines.back().words.empty() &&
+                         dl.lines.back().words.back().text.length() == 0;
+
+    replaceInDocLine(dl, hits, with);
+    dl.splitToLines();
+    dl.compileToText();
+
+    if (dl.words.empty())
+      dl.style = 'B';
+    else if (trailingSpace)
+      dl.lines.back().words.push_back({"", false, false});
+
+    docStats += countDocLine(dl);
+    count += hits.size();
+  }
+
+  if (count > 0) {
+    refreshAllLineIndexes();
+    updateScreen = true;
+  }
+  return count;
+}
+
+// Prompt for a search term and an optional replacement
+void findPrompt() {
+  String query = textPrompt("Find");
+  KB().setKeyboardState(NORMAL);
+  if (query == "_EXIT_" || query.length() == 0)
+    return;
+
+  setFindQuery(query);
+  findDoc = docIndexAtLine(lineScroll);
+  findPos = -1;
+
+  // An empty answer skips too, so a stray ENTER can't delete every match
+  String with = textPrompt("Replace All With (FN+< to skip)");
+  KB().setKeyboardState(NORMAL);
+  if (with != "_EXIT_" && with.length() > 0) {
+    int count = replaceAll(with);
+    OLED().oledWord("Replaced " + String(count));
+    delay(1000);
+    return;
+  }
+
+  if (!findStep(true)) {
+    OLED().oledWord("No matches");
+    delay(1000);
+  }
+}
+
 void editAppend(char inchar) {
   static ulong lastTypeMillis = 0;
   ulong currentMillis = millis();
@@ -1336,9 +1697,16 @@ void editAppend(char inchar) {
   }
   lastWord = &lastLine->words.back();
 
+  // Stats of the edited DocLine before this keystroke, applied as a delta afterwards
+  const size_t statsDocIndex = editingLine_index;
+  const size_t docCountBefore = docLines.size();
+  const ulong statsGeneration = docStatsGeneration;
+  DocStats statsBefore;
+
   if (inchar != 0) {
     // Increase clock speed here for faster processing?
     pocketmage::setCpuSpeed(240);
+    statsBefore = countDocLine(editingDocLine);
   }
 
   // HANDLE INPUTS
@@ -1384,9 +1752,10 @@ void editAppend(char inchar) {
   else if (inchar == 32) {
     if (getLineWidth(*lastLine, editingDocLine.style) > display.width() - DISPLAY_WIDTH_BUFFER) {
       // Word does not fit -> wrap to new line
-      // Remove the word from the old line
+      // Remove the word from the old line, and measure what stays on it
       wordObject movedWord = std::move(*lastWord);
       lastLine->words.pop_back();
+      lastLine->width = getLineWidth(*lastLine, editingDocLine.style);
 
       // Create new line, move the word into it
       LineObject newLine;
@@ -1434,6 +1803,9 @@ void editAppend(char inchar) {
       editingDocLine.words.clear();
       editingDocLine.parseWords();
       editingDocLine.splitToLines();
+      // The old LineObjects are gone
+      lastLine = &editingDocLine.lines.back();
+      lastWord = &lastLine->words.back();
     }
     // Blank Line
     bool currentLineEmpty = true;
@@ -1459,6 +1831,7 @@ void editAppend(char inchar) {
     if (getLineWidth(*lastLine, editingDocLine.style) > display.width() - DISPLAY_WIDTH_BUFFER) {
       wordObject movedWord = std::move(*lastWord);
       lastLine->words.pop_back();
+      lastLine->width = getLineWidth(*lastLine, editingDocLine.style);
 
       LineObject newLine;
       newLine.words.push_back(std::move(movedWord));
@@ -1467,6 +1840,8 @@ void editAppend(char inchar) {
       lastLine = &editingDocLine.lines.back();
       lastWord = &lastLine->words.back();
     }
+    // The finished DocLine's last line, the common re-measure below only sees the new one
+    lastLine->width = getLineWidth(*lastLine, editingDocLine.style);
 
     // Finish current DocLine and create a new one
     DocLine newDocLine;
@@ -1618,6 +1993,22 @@ void editAppend(char inchar) {
     loadMarkdownFile(outPath);
   }
 
+  // FN + SHFT + CENTER (Find & replace)
+  else if (inchar == 25) {
+    findPrompt();
+    // Replacing re-wraps lines, lastLine/lastWord are re-fetched next call
+    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
+    return;
+  }
+  // FN + SHFT + LEFT / RIGHT (Previous / next match)
+  else if (inchar == 24 || inchar == 26) {
+    KB().setKeyboardState(NORMAL);
+    if (findQuery.length() > 0 && !findStep(inchar == 26)) {
+      OLED().oledWord("No matches");
+      delay(1000);
+    }
+  }
+
   // Font Switcher
   else if (inchar == 14) {
     CurrentTXTState_NEW = FONT;
@@ -1639,9 +2030,21 @@ void editAppend(char inchar) {
     lastTypeMillis = millis();
   }
 
+  // A load already recounted everything, otherwise only the edited DocLine
+  // (and the one ENTER inserted after it) can have changed
+  if (inchar != 0 && statsGeneration == docStatsGeneration) {
+    // Re-measure the edited line once per keystroke rather than every OLED frame
+    lastLine->width = getLineWidth(*lastLine, docLines[editingLine_index].style);
+
+    docStats -= statsBefore;
+    docStats += countDocLine(docLines[statsDocIndex]);
+    if (docLines.size() > docCountBefore)
+      docStats += countDocLine(docLines[statsDocIndex + 1]);
+  }
+
   currentMillis = millis();
-  // Make sure oled only updates at 60fps
-  if (currentMillis - OLEDFPSMillis >= (1000 / 60)) {
+  // Make sure oled only updates at OLED_MAX_FPS
+  if (currentMillis - OLEDFPSMillis >= (1000 / OLED_MAX_FPS)) {
     OLEDFPSMillis = currentMillis;
     // Show line on OLED when not actively scrolling
     if (TOUCH().getLastTouch() == -1) {
@@ -1651,9 +2054,7 @@ void editAppend(char inchar) {
       if (!currentlyTyping)
         keypad.flush();
 
-      int lineWidth = getLineWidth(*lastLine, editingDocLine.style);
-
-      oledEditorDisplay(*lastLine, *lastWord, lineWidth, currentlyTyping);
+      oledEditorDisplay(*lastLine, *lastWord, lastLine->width, currentlyTyping);
     } else {
       // Scrolling display function here
       scrollPreview();
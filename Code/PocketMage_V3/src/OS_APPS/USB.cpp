@@ -35,6 +35,9 @@ void USBAppShutdown() {
 
   mscEnabled = false;
 
+  // The host may have changed anything on the card
+  PM_DIRS().clear();
+
   ESP_LOGI(TAG, "Re-mounting SD_MMC...");
 
   SD_MMC.end();  // Properly stop previous SD_MMC usage
@@ -69,27 +72,83 @@ void USBAppShutdown() {
   PowerSystem.setUSBControlBMS();
 }
 
+// Host traffic, sampled by processKB_USB() for the OLED throughput readout
+static volatile uint32_t bytesRead    = 0;
+static volatile uint32_t bytesWritten = 0;
+
+// Partial sectors go through here, whole ones go straight to and from the host buffer
+static uint8_t sectorBuf[512] __attribute__((aligned(4)));
+
+// One multi-block command for the whole sectors of a request. offset is a byte offset from lba,
+// a head or tail that only covers part of a sector is read (and for writes, merged and written
+// back) through sectorBuf.
+static bool transferSectors(bool write, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  const uint32_t secSize = card->csd.sector_size;
+  lba += offset / secSize;
+  offset %= secSize;
+
+  if ((offset || bufsize % secSize) && secSize > sizeof(sectorBuf)) return false;
+
+  // Head, the request starts inside a sector
+  if (offset) {
+    uint32_t n = min(bufsize, secSize - offset);
+    if (sdmmc_read_sectors(card, sectorBuf, lba, 1) != ESP_OK) return false;
+    if (write) {
+      memcpy(sectorBuf + offset, buffer, n);
+      if (sdmmc_write_sectors(card, sectorBuf, lba, 1) != ESP_OK) return false;
+    } else {
+      memcpy(buffer, sectorBuf + offset, n);
+    }
+    buffer += n;
+    bufsize -= n;
+    lba++;
+  }
+
+  // Body, every whole sector in one command
+  uint32_t count = bufsize / secSize;
+  if (count) {
+    esp_err_t err = write ? sdmmc_write_sectors(card, buffer, lba, count)
+                          : sdmmc_read_sectors(card, buffer, lba, count);
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "%s of %u sectors at %u failed: %s", write ? "Write" : "Read", count, lba,
+               esp_err_to_name(err));
+      return false;
+    }
+    buffer += count * secSize;
+    bufsize -= count * secSize;
+    lba += count;
+  }
+
+  // Tail, the request ends inside a sector
+  if (bufsize) {
+    if (sdmmc_read_sectors(card, sectorBuf, lba, 1) != ESP_OK) return false;
+    if (write) {
+      memcpy(sectorBuf, buffer, bufsize);
+      if (sdmmc_write_sectors(card, sectorBuf, lba, 1) != ESP_OK) return false;
+    } else {
+      memcpy(buffer, sectorBuf, bufsize);
+    }
+  }
+  return true;
+}
+
 static int32_t onWrite(uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
-  SDActive = true;
   if (!card || card->csd.sector_size == 0) return -1;
-  uint32_t secSize = card->csd.sector_size;
-  for (uint32_t i = 0; i < bufsize / secSize; ++i) {
-    esp_err_t err = sdmmc_write_sectors(card, buffer + i * secSize, lba + i, 1);
-    if (err != ESP_OK) return -1;
-  }
+  SDActive = true;
+  bool ok = transferSectors(true, lba, offset, buffer, bufsize);
   SDActive = false;
+  if (!ok) return -1;
+  bytesWritten += bufsize;
   return bufsize;
 }
 
 static int32_t onRead(uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
-  SDActive = true;
   if (!card || card->csd.sector_size == 0) return -1;
-  uint32_t secSize = card->csd.sector_size;
-  for (uint32_t i = 0; i < bufsize / secSize; ++i) {
-    esp_err_t err = sdmmc_read_sectors(card, (uint8_t*)buffer + i * secSize, lba + i, 1);
-    if (err != ESP_OK) return -1;
-  }
+  SDActive = true;
+  bool ok = transferSectors(false, lba, offset, (uint8_t*)buffer, bufsize);
   SDActive = false;
+  if (!ok) return -1;
+  bytesRead += bufsize;
   return bufsize;
 }
 
@@ -198,10 +257,31 @@ void USB_INIT() {
 
 void processKB_USB() {
   int currentMillis = millis();
+
+  // Host throughput over the last second
+  static int      rateMillis = 0;
+  static uint32_t lastRead = 0, lastWritten = 0;
+  static String   rateMsg = "";
+  if (currentMillis - rateMillis >= 1000) {
+    uint32_t readNow = bytesRead, writtenNow = bytesWritten;
+    float    secs    = (currentMillis - rateMillis) / 1000.0f;
+    float    readMB  = (readNow - lastRead) / secs / 1048576.0f;
+    float    writeMB = (writtenNow - lastWritten) / secs / 1048576.0f;
+
+    if (readMB >= 0.01f || writeMB >= 0.01f)
+      rateMsg = "R " + String(readMB, 2) + " W " + String(writeMB, 2) + " MB/s";
+    else
+      rateMsg = "";
+
+    lastRead    = readNow;
+    lastWritten = writtenNow;
+    rateMillis  = currentMillis;
+  }
+
   //Make sure oled only updates at 10FPS
   if (currentMillis - OLEDFPSMillis >= (1000/10 /*OLED_MAX_FPS*/)) {
     OLEDFPSMillis = currentMillis;
-    OLED().oledLine(currentLine, currentLine.length(), false);
+    OLED().oledLine(currentLine, currentLine.length(), false, rateMsg);
   }
   
   if (currentMillis - KBBounceMillis >= KB_COOLDOWN) {  
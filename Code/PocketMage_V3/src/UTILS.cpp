@@ -62,7 +62,6 @@ void checkTimeout() {
         case TXT:
           if (SLEEPMODE == "TEXT" && PM_SDAUTO().getEditingFile() != "" && !OTA_APP) {
             /*
-            EINK().setFullRefreshAfter(FULL_REFRESH_AFTER + 1);
             display.setFullWindow();
             EINK().einkTextDynamic(true, true);
 
@@ -138,7 +137,6 @@ void checkTimeout() {
         case TXT:
           if (SLEEPMODE == "TEXT" && PM_SDAUTO().getEditingFile() != "" && !OTA_APP) {
             ESP_LOGE(TAG, "text sleep mode");
-            EINK().setFullRefreshAfter(FULL_REFRESH_AFTER + 1);
             display.setFullWindow();
             EINK().einkTextDynamic(true, true);
             display.setFont(&FreeMonoBold9pt7b);
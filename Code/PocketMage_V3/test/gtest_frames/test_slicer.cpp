@@ -0,0 +1,172 @@
+// Frame line slicing: sliceToWidth() against the old re-measure-the-prefix slicer, and how long
+// each takes to wrap the same FixedArenaSource lines. pio test -e native -f gtest_frames
+#include <gtest/gtest.h>
+#include <pocketmage_text.h>
+#include <pocketmage_textsource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+// Same layout as Adafruit_GFX's gfxfont.h, so the firmware's fonts load unchanged
+#define PROGMEM
+struct GFXglyph {
+  uint16_t bitmapOffset;
+  uint8_t  width;
+  uint8_t  height;
+  uint8_t  xAdvance;
+  int8_t   xOffset;
+  int8_t   yOffset;
+};
+struct GFXfont {
+  uint8_t*  bitmap;
+  GFXglyph* glyph;
+  uint16_t  first;
+  uint16_t  last;
+  uint8_t   yAdvance;
+};
+#include "../../lib/PocketMage/include/Fonts/FreeMono9pt8b.h"
+#include "../../lib/PocketMage/include/Fonts/FreeSerif9pt8b.h"
+
+namespace {
+
+constexpr int TEXT_WIDTH = 310;   // a frame across the e-ink panel
+
+// What sliceThatFits() did before: measure the whole prefix again after every char
+size_t sliceByPrefix(const GFXfont* font, const char* s, size_t n, int maxWidth) {
+  if (!s || n == 0) return 0;
+
+  size_t best = 0, lastSpace = SIZE_MAX;
+  size_t i = 0;
+  while (i < n) {
+    char c = s[i];
+    if (c == '\n' || c == '\r') return (best > 0) ? best : 1;
+    if (c == ' ') lastSpace = i;
+
+    InkBoundsT<GFXfont> prefix(font);
+    prefix.add(s, i + 1);
+    if ((int)prefix.width() > maxWidth) break;
+
+    best = i + 1;
+    ++i;
+  }
+
+  const bool overflowed = (i < n);
+  if (best == 0) return 1;
+  if (overflowed && lastSpace != SIZE_MAX && lastSpace + 1 <= best) return lastSpace + 1;
+  return best;
+}
+
+// Words of random length, the odd newline
+std::string makeText(size_t len, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::string s;
+  while (s.size() < len) {
+    size_t word = 1 + rng() % 9;
+    for (size_t k = 0; k < word; ++k) s += (char)('a' + rng() % 26);
+    s += (rng() % 40 == 0) ? '\n' : ' ';
+  }
+  s.resize(len);
+  return s;
+}
+
+// Arena lines are single lines, as pushed by the frames
+std::string makeLine(size_t len, unsigned seed) {
+  std::string s = makeText(len, seed);
+  for (char& c : s)
+    if (c == '\n') c = ' ';
+  return s;
+}
+
+// Every row of every source line, the way wrapLine() walks a LineView
+template <class Slicer>
+size_t wrapAll(const GFXfont* font, const TextSource& src, int width, Slicer slice) {
+  size_t rows = 0;
+  for (size_t i = 0; i < src.size(); ++i) {
+    LineView lv = src.line(i);
+    size_t pos = 0;
+    while (pos < lv.len) {
+      pos += slice(font, lv.ptr + pos, lv.len - pos, width);
+      ++rows;
+    }
+  }
+  return rows;
+}
+
+template <class Fn>
+double millisOf(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+TEST(Slicer, MatchesPrefixMeasuring) {
+  const GFXfont* fonts[] = { &FreeMono9pt8b, &FreeSerif9pt8b, nullptr };
+  const int widths[] = { 1, 12, 80, TEXT_WIDTH, 2000 };
+
+  for (const GFXfont* font : fonts) {
+    for (int width : widths) {
+      for (unsigned seed = 1; seed <= 20; ++seed) {
+        std::string text = makeText(300, seed);
+        for (size_t pos = 0; pos < text.size(); pos += 7) {
+          const char* s = text.data() + pos;
+          size_t n = text.size() - pos;
+          ASSERT_EQ(sliceToWidth(font, s, n, width), sliceByPrefix(font, s, n, width))
+              << "seed " << seed << " width " << width << " pos " << pos;
+        }
+      }
+    }
+  }
+}
+
+TEST(Slicer, BreaksAfterSpacesAndAtNewlines) {
+  const char* s = "hello world";
+  InkBoundsT<GFXfont> hello(&FreeSerif9pt8b);
+  hello.add("hello w", 7);
+
+  // "hello w" fits but "hello wo" doesn't: break after the space
+  EXPECT_EQ(sliceToWidth(&FreeSerif9pt8b, s, strlen(s), hello.width()), 6u);
+  EXPECT_EQ(sliceToWidth(&FreeSerif9pt8b, s, strlen(s), 10000), strlen(s));
+  EXPECT_EQ(sliceToWidth(&FreeSerif9pt8b, "ab\ncd", 5, 10000), 2u);
+  EXPECT_EQ(sliceToWidth(&FreeSerif9pt8b, "\ncd", 3, 10000), 1u);
+  // A char wider than the frame still moves forward
+  EXPECT_EQ(sliceToWidth(&FreeSerif9pt8b, "W", 1, 1), 1u);
+  EXPECT_EQ(sliceToWidth(&FreeSerif9pt8b, "", 0, 100), 0u);
+}
+
+TEST(SlicerBenchmark, WrapLongArenaLines) {
+  // 60 KB of text in 4000 char lines, plus one line that never breaks
+  static FixedArenaSource<32, 65535> arena;
+  for (unsigned seed = 1; seed <= 15; ++seed) {
+    std::string line = makeLine(4000, seed);
+    ASSERT_TRUE(arena.pushLine(line.data(), (uint16_t)line.size()));
+  }
+  size_t rowsFast = 0, rowsRef = 0;
+  double fastMs = millisOf([&] { rowsFast = wrapAll(&FreeSerif9pt8b, arena, TEXT_WIDTH, sliceToWidth<GFXfont>); });
+  double refMs  = millisOf([&] { rowsRef  = wrapAll(&FreeSerif9pt8b, arena, TEXT_WIDTH, sliceByPrefix); });
+  EXPECT_EQ(rowsFast, rowsRef);
+  printf("[ BENCH    ] %zu arena lines, %zu bytes at %d px: %zu rows, %.2f ms linear, %.2f ms prefix\n",
+         arena.size(), arena.used, TEXT_WIDTH, rowsFast, fastMs, refMs);
+
+  // One row that never breaks is where re-measuring the prefix goes quadratic
+  static FixedArenaSource<1, 4097> unbroken;
+  std::string row(4096, 'i');
+  ASSERT_TRUE(unbroken.pushLine(row.data(), (uint16_t)row.size()));
+  LineView lv = unbroken.line(0);
+  size_t sliceFast = 0, sliceRef = 0;
+  fastMs = millisOf([&] { sliceFast = sliceToWidth(&FreeSerif9pt8b, lv.ptr, lv.len, 1 << 20); });
+  refMs  = millisOf([&] { sliceRef  = sliceByPrefix(&FreeSerif9pt8b, lv.ptr, lv.len, 1 << 20); });
+  EXPECT_EQ(sliceFast, (size_t)lv.len);
+  EXPECT_EQ(sliceFast, sliceRef);
+  printf("[ BENCH    ] %u char arena line: %.3f ms linear, %.2f ms prefix\n", lv.len, fastMs, refMs);
+  EXPECT_LT(fastMs, refMs);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
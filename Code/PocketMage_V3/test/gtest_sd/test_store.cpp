@@ -0,0 +1,243 @@
+// PocketmageStore against a temp directory, the same code PocketmageSD runs on the card.
+// pio test -e native -f gtest_sd
+#include <gtest/gtest.h>
+#include <pocketmage_fs_posix.h>
+#include <pocketmage_store.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+std::string makeTempDir() {
+  char tmpl[] = "/tmp/pm_sd_XXXXXX";
+  const char* dir = mkdtemp(tmpl);
+  return dir ? dir : "";
+}
+
+void removeTree(PocketmageFs& fs, const std::string& dir) {
+  std::vector<PocketmageFs::Entry> entries;
+  fs.list(dir.c_str(), entries);
+  for (const PocketmageFs::Entry& e : entries) {
+    std::string path = (dir == "/" ? "" : dir) + "/" + e.name;
+    if (e.isDir)
+      removeTree(fs, path);
+    else
+      fs.remove(path.c_str());
+  }
+  if (dir != "/") fs.rmdir(dir.c_str());
+}
+
+class StoreTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    root_ = makeTempDir();
+    ASSERT_FALSE(root_.empty());
+    fs_.reset(new PocketmagePosixFs(root_));
+    store_.reset(new PocketmageStore(*fs_));
+    store_->onChanged([this](const std::string& path) { changed_.push_back(path); });
+  }
+  void TearDown() override {
+    removeTree(*fs_, "/");
+    rmdir(root_.c_str());
+  }
+
+  std::string read(const char* path) {
+    std::string out;
+    EXPECT_TRUE(store_->readFile(path, out)) << path;
+    return out;
+  }
+  bool changed(const std::string& path) {
+    return std::find(changed_.begin(), changed_.end(), path) != changed_.end();
+  }
+
+  std::string                        root_;
+  std::unique_ptr<PocketmagePosixFs> fs_;
+  std::unique_ptr<PocketmageStore>   store_;
+  std::vector<std::string>           changed_;
+};
+
+}  // namespace
+
+TEST(StoreHelpers, NormalizePaths) {
+  EXPECT_EQ(PocketmageStore::normalize("notes/a.txt"), "/notes/a.txt");
+  EXPECT_EQ(PocketmageStore::normalize("/notes/"), "/notes");
+  EXPECT_EQ(PocketmageStore::normalize("/"), "/");
+  EXPECT_EQ(PocketmageStore::normalize(""), "/");
+}
+
+TEST(StoreHelpers, CountVisibleChars) {
+  const char* s = "ab c\t\r\n~\x7f";
+  EXPECT_EQ(PocketmageStore::countVisibleChars(s, strlen(s)), 5u);
+  EXPECT_EQ(PocketmageStore::countVisibleChars("", 0), 0u);
+}
+
+TEST_F(StoreTest, WriteThenRead) {
+  ASSERT_TRUE(store_->writeFile("/a.txt", "hello", 5));
+  EXPECT_EQ(read("/a.txt"), "hello");
+  EXPECT_EQ(store_->fileSize("/a.txt"), 5);
+  EXPECT_TRUE(changed("/a.txt"));
+
+  // Overwrites, doesn't append
+  ASSERT_TRUE(store_->writeFile("/a.txt", "hi", 2));
+  EXPECT_EQ(read("/a.txt"), "hi");
+}
+
+TEST_F(StoreTest, AppendExtendsFile) {
+  ASSERT_TRUE(store_->appendFile("/log.txt", "one\n", 4));
+  ASSERT_TRUE(store_->appendFile("/log.txt", "two\n", 4));
+  EXPECT_EQ(read("/log.txt"), "one\ntwo\n");
+}
+
+TEST_F(StoreTest, ReadsLargerThanOneBlock) {
+  std::string big(5000, 'x');
+  for (size_t i = 0; i < big.size(); i++) big[i] = 'a' + i % 26;
+  ASSERT_TRUE(store_->writeFile("/big.txt", big.data(), big.size()));
+  EXPECT_EQ(read("/big.txt"), big);
+}
+
+TEST_F(StoreTest, WriteLinesCountsVisibleChars) {
+  std::vector<std::string> lines = {"first", "", "third\tline"};
+  EXPECT_EQ(store_->writeLines("/lines.txt", lines), 14);
+  EXPECT_EQ(read("/lines.txt"), "first\n\nthird\tline\n");
+
+  // More lines than one Writer chunk
+  std::vector<std::string> many(200, std::string("0123456789"));
+  EXPECT_EQ(store_->writeLines("/lines.txt", many, true), 2000);
+  EXPECT_EQ(store_->fileSize("/lines.txt"), 18 + 200 * 11);
+}
+
+TEST_F(StoreTest, WriteLinesFailsWithoutDirectory) {
+  std::vector<std::string> lines = {"x"};
+  EXPECT_EQ(store_->writeLines("/missing/lines.txt", lines), -1);
+}
+
+TEST_F(StoreTest, RenameMovesFile) {
+  ASSERT_TRUE(store_->writeFile("/old.txt", "data", 4));
+  changed_.clear();
+  ASSERT_TRUE(store_->rename("/old.txt", "/new.txt"));
+  EXPECT_EQ(store_->fileSize("/old.txt"), -1);
+  EXPECT_EQ(read("/new.txt"), "data");
+  EXPECT_TRUE(changed("/old.txt"));
+  EXPECT_TRUE(changed("/new.txt"));
+
+  EXPECT_FALSE(store_->rename("/nothing.txt", "/other.txt"));
+}
+
+TEST_F(StoreTest, RemoveDeletesFile) {
+  ASSERT_TRUE(store_->writeFile("/gone.txt", "x", 1));
+  ASSERT_TRUE(store_->remove("/gone.txt"));
+  EXPECT_FALSE(fs_->exists("/gone.txt"));
+  EXPECT_FALSE(store_->remove("/gone.txt"));
+}
+
+TEST_F(StoreTest, ReadBinaryNeedsEveryByte) {
+  const uint8_t data[] = {0, 1, 2, 255, 0, 7};
+  ASSERT_TRUE(store_->writeFile("/bin.dat", (const char*)data, sizeof(data)));
+
+  uint8_t buf[sizeof(data)] = {};
+  ASSERT_TRUE(store_->readBinary("/bin.dat", buf, sizeof(buf)));
+  EXPECT_EQ(memcmp(buf, data, sizeof(data)), 0);
+
+  uint8_t tooBig[sizeof(data) + 1];
+  EXPECT_FALSE(store_->readBinary("/bin.dat", tooBig, sizeof(tooBig)));
+}
+
+TEST_F(StoreTest, MissingFilesFail) {
+  std::string out = "stale";
+  EXPECT_FALSE(store_->readFile("/missing.txt", out));
+  EXPECT_TRUE(out.empty());
+  EXPECT_EQ(store_->fileSize("/missing.txt"), -1);
+  uint8_t buf[4];
+  EXPECT_FALSE(store_->readBinary("/missing.txt", buf, sizeof(buf)));
+  EXPECT_FALSE(store_->writeFile("/missing/a.txt", "x", 1));
+}
+
+TEST_F(StoreTest, DirectoriesAreNotFiles) {
+  ASSERT_TRUE(fs_->mkdir("/dir"));
+  std::string out;
+  EXPECT_FALSE(store_->readFile("/dir", out));
+  EXPECT_EQ(store_->fileSize("/dir"), -1);
+}
+
+TEST_F(StoreTest, ListReportsEntries) {
+  ASSERT_TRUE(fs_->mkdir("/notes"));
+  ASSERT_TRUE(fs_->mkdir("/notes/sub"));
+  ASSERT_TRUE(store_->writeFile("/notes/a.txt", "abc", 3));
+
+  std::vector<PocketmageFs::Entry> entries;
+  ASSERT_TRUE(store_->list("/notes", entries));
+  std::sort(entries.begin(), entries.end(),
+            [](const PocketmageFs::Entry& a, const PocketmageFs::Entry& b) { return a.name < b.name; });
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].name, "a.txt");
+  EXPECT_FALSE(entries[0].isDir);
+  EXPECT_EQ(entries[0].size, 3u);
+  EXPECT_EQ(entries[1].name, "sub");
+  EXPECT_TRUE(entries[1].isDir);
+
+  EXPECT_FALSE(store_->list("/notes/a.txt", entries));
+  EXPECT_FALSE(store_->list("/missing", entries));
+}
+
+TEST_F(StoreTest, CopyFileReportsProgress) {
+  std::string data(3000, 'q');
+  ASSERT_TRUE(store_->writeFile("/src.txt", data.data(), data.size()));
+
+  uint8_t buf[1024];
+  std::vector<size_t> seen;
+  size_t total = 0;
+  ASSERT_TRUE(store_->copy("src.txt", "/dst.txt/", buf, sizeof(buf), [&](size_t done, size_t t) {
+    seen.push_back(done);
+    total = t;
+  }));
+  EXPECT_EQ(read("/dst.txt"), data);
+  EXPECT_EQ(total, data.size());
+  EXPECT_EQ(seen, (std::vector<size_t>{1024, 2048, 3000}));
+  EXPECT_TRUE(changed("/dst.txt"));
+}
+
+TEST_F(StoreTest, CopyTree) {
+  ASSERT_TRUE(fs_->mkdir("/app"));
+  ASSERT_TRUE(fs_->mkdir("/app/assets"));
+  ASSERT_TRUE(store_->writeFile("/app/main.bin", "12345", 5));
+  ASSERT_TRUE(store_->writeFile("/app/assets/icon.bmp", "abc", 3));
+
+  uint8_t buf[2];
+  size_t last = 0, total = 0;
+  ASSERT_TRUE(store_->copy("/app", "/copy", buf, sizeof(buf), [&](size_t done, size_t t) {
+    last  = done;
+    total = t;
+  }));
+  EXPECT_EQ(read("/copy/main.bin"), "12345");
+  EXPECT_EQ(read("/copy/assets/icon.bmp"), "abc");
+  EXPECT_EQ(total, 8u);
+  EXPECT_EQ(last, 8u);
+  EXPECT_TRUE(changed("/copy"));
+  EXPECT_TRUE(changed("/copy/assets/icon.bmp"));
+}
+
+TEST_F(StoreTest, CopyRefusesBadRequests) {
+  ASSERT_TRUE(fs_->mkdir("/app"));
+  ASSERT_TRUE(store_->writeFile("/app/a.txt", "a", 1));
+  uint8_t buf[16];
+
+  EXPECT_FALSE(store_->copy("/app", "/app/inner", buf, sizeof(buf)));
+  EXPECT_FALSE(store_->copy("/app", "/app", buf, sizeof(buf)));
+  EXPECT_FALSE(store_->copy("/missing", "/dst", buf, sizeof(buf)));
+  EXPECT_FALSE(store_->copy("/app/a.txt", "/b.txt", nullptr, 0));
+  EXPECT_FALSE(fs_->exists("/app/inner"));
+
+  // A sibling that only shares the prefix is fine
+  EXPECT_TRUE(store_->copy("/app", "/app2", buf, sizeof(buf)));
+  EXPECT_EQ(read("/app2/a.txt"), "a");
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}